@@ -0,0 +1,442 @@
+// benchmark and accuracy harness for the Math.h / Transform.h API
+// every function is timed over arrays of realistic inputs (unit
+// quats, bone sized offsets, scales around 1) and checked against a
+// double precision reference implementation written out below
+// build and run with: make mathbench
+#include "../src/Math.h"
+#include "../src/Transform.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+const unsigned int NUM_INPUTS = 4096;
+const unsigned int NUM_REPEATS = 200;
+
+// outputs smaller than ULP_FLOOR are measured in ulps of ULP_FLOOR
+// every output here (rotations, offsets, scales) is of order 1, and
+// an error of 1e-9 on an output of 1e-12 would report millions of ulps
+const double ULP_FLOOR = 1.0;
+
+// **********************//
+//                       //
+//      Test inputs      //
+//                       //
+// **********************//
+
+static float RandomFloat(float min, float max)
+{
+  return min + (max - min) * ((float) rand() / (float) RAND_MAX);
+}
+
+static quat RandomQuat()
+{
+  quat q(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+  return normalized(q);
+}
+
+// local joint transform: offsets up to a metre, mostly unit scale
+// with some uniformly scaled joints (non uniform scale can't be
+// combined exactly, so it would only measure the TRS model itself)
+static Transform RandomTransform()
+{
+  Transform t;
+  t.position = vec3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+  t.rotation = RandomQuat();
+  float s = rand() % 4 == 0 ? RandomFloat(0.5f, 2.0f) : 1.0f;
+  t.scale = vec3(s, s, s);
+  return t;
+}
+
+// **********************//
+//                       //
+//  double reference     //
+//                       //
+// **********************//
+
+struct dquat { double x, y, z, w; };
+struct dmat4 { double v[16]; };
+
+static dquat ToDouble(const quat& q)
+{
+  dquat r = { q.x, q.y, q.z, q.w };
+  double l = std::sqrt(r.x * r.x + r.y * r.y + r.z * r.z + r.w * r.w);
+  r.x /= l; r.y /= l; r.z /= l; r.w /= l;
+  return r;
+}
+
+static dmat4 ToDouble(const mat4& m)
+{
+  dmat4 r;
+  for (int i = 0; i < 16; ++i) { r.v[i] = m.v[i]; }
+  return r;
+}
+
+// hamilton product, a * b rotates by b first then a
+static dquat Mul(const dquat& a, const dquat& b)
+{
+  dquat r = {
+      a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y
+    , a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x
+    , a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+    , a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+  };
+  return r;
+}
+
+static dmat4 Mul(const dmat4& a, const dmat4& b)
+{
+  dmat4 r;
+  for (int c = 0; c < 4; ++c)
+  {
+    for (int row = 0; row < 4; ++row)
+    {
+      double sum = 0.0;
+      for (int k = 0; k < 4; ++k) { sum += a.v[k * 4 + row] * b.v[c * 4 + k]; }
+      r.v[c * 4 + row] = sum;
+    }
+  }
+  return r;
+}
+
+// gauss-jordan elimination with partial pivoting
+static dmat4 Inverse(const dmat4& m)
+{
+  double a[4][8];
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int c = 0; c < 4; ++c)
+    {
+      a[row][c] = m.v[c * 4 + row];
+      a[row][c + 4] = row == c ? 1.0 : 0.0;
+    }
+  }
+  for (int c = 0; c < 4; ++c)
+  {
+    int pivot = c;
+    for (int row = c + 1; row < 4; ++row)
+    {
+      if (std::fabs(a[row][c]) > std::fabs(a[pivot][c])) { pivot = row; }
+    }
+    for (int k = 0; k < 8; ++k) { double t = a[c][k]; a[c][k] = a[pivot][k]; a[pivot][k] = t; }
+    double inv = 1.0 / a[c][c];
+    for (int k = 0; k < 8; ++k) { a[c][k] *= inv; }
+    for (int row = 0; row < 4; ++row)
+    {
+      if (row == c) { continue; }
+      double f = a[row][c];
+      for (int k = 0; k < 8; ++k) { a[row][k] -= f * a[c][k]; }
+    }
+  }
+  dmat4 r;
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int c = 0; c < 4; ++c) { r.v[c * 4 + row] = a[row][c + 4]; }
+  }
+  return r;
+}
+
+// closed form rotation matrix, column major
+static dmat4 QuatToMat4(const dquat& q)
+{
+  double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+  double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+  double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+  dmat4 r = { {
+      1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0
+    , 2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0
+    , 2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0
+    , 0, 0, 0, 1
+  } };
+  return r;
+}
+
+static dmat4 TransformToMat4(const Transform& t)
+{
+  dmat4 r = QuatToMat4(ToDouble(t.rotation));
+  double s[3] = { t.scale.x, t.scale.y, t.scale.z };
+  for (int c = 0; c < 3; ++c)
+  {
+    for (int row = 0; row < 3; ++row) { r.v[c * 4 + row] *= s[c]; }
+  }
+  r.v[12] = t.position.x; r.v[13] = t.position.y; r.v[14] = t.position.z;
+  return r;
+}
+
+// slerp on the 4d sphere doesn't depend on the multiplication order
+static dquat Slerp(const dquat& a, const dquat& b, double t)
+{
+  double d = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+  double theta = std::acos(d > 1.0 ? 1.0 : d);
+  double s = std::sin(theta);
+  double wa = s < 1e-12 ? 1.0 - t : std::sin((1.0 - t) * theta) / s;
+  double wb = s < 1e-12 ? t : std::sin(t * theta) / s;
+  dquat r = { a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb };
+  return r;
+}
+
+static dquat Nlerp(const dquat& a, const dquat& b, double t)
+{
+  dquat r = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+  double l = std::sqrt(r.x * r.x + r.y * r.y + r.z * r.z + r.w * r.w);
+  r.x /= l; r.y /= l; r.z /= l; r.w /= l;
+  return r;
+}
+
+// **********************//
+//                       //
+//   error accumulation  //
+//                       //
+// **********************//
+
+struct Error
+{
+  double maxAbs;
+  double maxUlp;
+  Error() : maxAbs(0.0), maxUlp(0.0) {}
+};
+
+static void Accumulate(Error& e, float value, double reference)
+{
+  double err = std::fabs((double) value - reference);
+  double mag = std::fabs(reference) < ULP_FLOOR ? ULP_FLOOR : std::fabs(reference);
+  float f = (float) mag;
+  double ulp = (double) std::nextafter(f, 2.0f * f) - (double) f;
+  if (err != err)
+  {
+    // NaN, report it as loudly as possible
+    err = INFINITY;
+  }
+  e.maxAbs = std::fmax(e.maxAbs, err);
+  e.maxUlp = std::fmax(e.maxUlp, err / ulp);
+}
+
+static void Accumulate(Error& e, const mat4& m, const dmat4& reference)
+{
+  for (int i = 0; i < 16; ++i) { Accumulate(e, m.v[i], reference.v[i]); }
+}
+
+// q and -q are the same rotation, compare against the closer one
+static void Accumulate(Error& e, const quat& q, const dquat& reference)
+{
+  double sign = q.x * reference.x + q.y * reference.y
+              + q.z * reference.z + q.w * reference.w < 0.0 ? -1.0 : 1.0;
+  Accumulate(e, q.x, reference.x * sign);
+  Accumulate(e, q.y, reference.y * sign);
+  Accumulate(e, q.z, reference.z * sign);
+  Accumulate(e, q.w, reference.w * sign);
+}
+
+static void Accumulate(Error& e, const vec3& v, const double* reference)
+{
+  Accumulate(e, v.x, reference[0]);
+  Accumulate(e, v.y, reference[1]);
+  Accumulate(e, v.z, reference[2]);
+}
+
+// **********************//
+//                       //
+//        timing         //
+//                       //
+// **********************//
+
+// anything written here can't be optimized away
+volatile float g_Sink;
+
+// ns per call of body(i) for i over all inputs
+template<typename F>
+static double Time(F body)
+{
+  float sum = 0.0f;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (unsigned int r = 0; r < NUM_REPEATS; ++r)
+  {
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      sum += body(i);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  g_Sink = sum;
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / ((double) NUM_INPUTS * NUM_REPEATS);
+}
+
+static void Report(const char* name, double ns, const Error& e)
+{
+  printf("%-16s %10.2f %14.3g %12.1f\n", name, ns, e.maxAbs, e.maxUlp);
+}
+
+int main(int argc, char* args[])
+{
+  srand(42);
+
+  std::vector<Transform> ta(NUM_INPUTS), tb(NUM_INPUTS);
+  std::vector<mat4> ma(NUM_INPUTS), mb(NUM_INPUTS), rot(NUM_INPUTS);
+  std::vector<quat> qa(NUM_INPUTS), qb(NUM_INPUTS);
+  std::vector<float> ts(NUM_INPUTS);
+  for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+  {
+    ta[i] = RandomTransform();
+    tb[i] = RandomTransform();
+    ma[i] = transformToMat4(ta[i]);
+    mb[i] = transformToMat4(tb[i]);
+    qa[i] = ta[i].rotation;
+    // interpolation inputs are keyframe neighbours: same
+    // neighborhood, usually less than 90 degrees apart
+    qb[i] = normalized(qa[i] * angleAxis(RandomFloat(-1.5f, 1.5f),
+      vec3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1))));
+    if (dot(qa[i], qb[i]) < 0.0f)
+    {
+      qb[i] = -qb[i];
+    }
+    rot[i] = quatToMat4(qa[i]);
+    ts[i] = RandomFloat(0.0f, 1.0f);
+  }
+
+  printf("%u inputs x %u repeats\n", NUM_INPUTS, NUM_REPEATS);
+  printf("%-16s %10s %14s %12s\n", "function", "ns/call", "max abs err", "max ulp");
+
+  // mat4 * mat4
+  {
+    double ns = Time([&](unsigned int i) { return (ma[i] * mb[i]).v[0]; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, ma[i] * mb[i], Mul(ToDouble(ma[i]), ToDouble(mb[i])));
+    }
+    Report("mat4 * mat4", ns, e);
+  }
+
+  // inverse(mat4)
+  {
+    double ns = Time([&](unsigned int i) { return inverse(ma[i]).v[0]; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, inverse(ma[i]), Inverse(ToDouble(ma[i])));
+    }
+    Report("inverse(mat4)", ns, e);
+  }
+
+  // quatToMat4
+  {
+    double ns = Time([&](unsigned int i) { return quatToMat4(qa[i]).v[0]; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, quatToMat4(qa[i]), QuatToMat4(ToDouble(qa[i])));
+    }
+    Report("quatToMat4", ns, e);
+  }
+
+  // mat4ToQuat, the input is the rotation matrix of a known quat
+  {
+    double ns = Time([&](unsigned int i) { return mat4ToQuat(rot[i]).w; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, mat4ToQuat(rot[i]), ToDouble(qa[i]));
+    }
+    Report("mat4ToQuat", ns, e);
+  }
+
+  // slerp
+  {
+    double ns = Time([&](unsigned int i) { return slerp(qa[i], qb[i], ts[i]).w; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, slerp(qa[i], qb[i], ts[i]), Slerp(ToDouble(qa[i]), ToDouble(qb[i]), ts[i]));
+    }
+    Report("slerp", ns, e);
+  }
+
+  // fastSlerp, an approximation so the error is expected to be larger
+  {
+    double ns = Time([&](unsigned int i) { return fastSlerp(qa[i], qb[i], ts[i]).w; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, fastSlerp(qa[i], qb[i], ts[i]), Slerp(ToDouble(qa[i]), ToDouble(qb[i]), ts[i]));
+    }
+    Report("fastSlerp", ns, e);
+  }
+
+  // nlerp
+  {
+    double ns = Time([&](unsigned int i) { return nlerp(qa[i], qb[i], ts[i]).w; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, nlerp(qa[i], qb[i], ts[i]), Nlerp(ToDouble(qa[i]), ToDouble(qb[i]), ts[i]));
+    }
+    Report("nlerp", ns, e);
+  }
+
+  // transformToMat4
+  {
+    double ns = Time([&](unsigned int i) { return transformToMat4(ta[i]).v[0]; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, transformToMat4(ta[i]), TransformToMat4(ta[i]));
+    }
+    Report("transformToMat4", ns, e);
+  }
+
+  // batched transformToMat4 over aligned transforms, the palette path
+  {
+    std::vector<TransformA> aligned(NUM_INPUTS);
+    std::vector<mat4> palette(NUM_INPUTS);
+    toTransformA(&ta[0], &aligned[0], NUM_INPUTS);
+    float sum = 0.0f;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int r = 0; r < NUM_REPEATS; ++r)
+    {
+      transformToMat4(&aligned[0], &palette[0], NUM_INPUTS);
+      sum += palette[r % NUM_INPUTS].v[0];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    g_Sink = sum;
+    double ns = std::chrono::duration<double, std::nano>(end - start).count()
+              / ((double) NUM_INPUTS * NUM_REPEATS);
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Accumulate(e, palette[i], TransformToMat4(ta[i]));
+    }
+    Report("transformToMat4[]", ns, e);
+  }
+
+  // combine, compared component wise against the same composition in
+  // double: scale * scale, parent rotation after child rotation and
+  // the child position moved into the parent's space
+  {
+    double ns = Time([&](unsigned int i) { return combine(ta[i], tb[i]).position.x; });
+    Error e;
+    for (unsigned int i = 0; i < NUM_INPUTS; ++i)
+    {
+      Transform c = combine(ta[i], tb[i]);
+      dmat4 parent = TransformToMat4(ta[i]);
+      double p[3];
+      for (int row = 0; row < 3; ++row)
+      {
+        p[row] = parent.v[row] * tb[i].position.x + parent.v[4 + row] * tb[i].position.y
+               + parent.v[8 + row] * tb[i].position.z + parent.v[12 + row];
+      }
+      double s[3] = {
+          (double) ta[i].scale.x * tb[i].scale.x
+        , (double) ta[i].scale.y * tb[i].scale.y
+        , (double) ta[i].scale.z * tb[i].scale.z
+      };
+      Accumulate(e, c.position, p);
+      Accumulate(e, c.scale, s);
+      Accumulate(e, c.rotation, Mul(ToDouble(ta[i].rotation), ToDouble(tb[i].rotation)));
+    }
+    Report("combine", ns, e);
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+// accuracy report for the fast trig approximations in Math.cpp
+// compares every fast function against its libm based version
+// and prints the max absolute error plus a rough cost per call
+#include "../src/Math.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static float RandomFloat(float min, float max)
+{
+  return min + (max - min) * ((float) rand() / (float) RAND_MAX);
+}
+
+static quat RandomQuat()
+{
+  vec3 axis(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+  return angleAxis(RandomFloat(-3.14159f, 3.14159f), axis);
+}
+
+// angle (radians) between the orientations of two quats
+// acos of the dot product is too noisy near 1, so the chord length
+// between the quats is used instead: angle = 4 * asin(chord / 2)
+static double QuatError(const quat& a, const quat& b)
+{
+  double sign = dot(a, b) < 0.0f ? -1.0 : 1.0;
+  double dx = a.x - sign * b.x, dy = a.y - sign * b.y;
+  double dz = a.z - sign * b.z, dw = a.w - sign * b.w;
+  double chord = std::sqrt(dx * dx + dy * dy + dz * dz + dw * dw);
+  return 4.0 * std::asin(chord > 2.0 ? 1.0 : chord * 0.5);
+}
+
+static void Report(const char* name, double maxError, const char* unit)
+{
+  std::cout << name << "\tmax error " << maxError << " " << unit << "\n";
+}
+
+// every timed sum is stored here, a volatile global can't be
+// optimized away so neither can the loops that feed it
+static volatile float s_Sink = 0.0f;
+
+// ns per call of f over inputs
+template<typename F>
+static double Time(const std::vector<float>& inputs, F f)
+{
+  float sum = 0.0f;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int r = 0; r < 10; ++r)
+  {
+    for (unsigned int i = 0; i < inputs.size(); ++i)
+    {
+      sum += f(inputs[i]);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  s_Sink = s_Sink + sum;
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / (inputs.size() * 10.0);
+}
+
+int main()
+{
+  const int SAMPLES = 1000000;
+  srand(1234);
+
+  double sinErr = 0.0, cosErr = 0.0, acosErr = 0.0;
+  std::vector<float> angles(SAMPLES), cosines(SAMPLES);
+  for (int i = 0; i < SAMPLES; ++i)
+  {
+    // sweep the whole range evenly instead of sampling randomly
+    float x = -6.28318f + 12.56637f * ((float) i / (SAMPLES - 1));
+    float c = -1.0f + 2.0f * ((float) i / (SAMPLES - 1));
+    angles[i] = x;
+    cosines[i] = c;
+    sinErr = std::fmax(sinErr, std::fabs((double) fastSin(x) - std::sin((double) x)));
+    cosErr = std::fmax(cosErr, std::fabs((double) fastCos(x) - std::cos((double) x)));
+    acosErr = std::fmax(acosErr, std::fabs((double) fastAcos(c) - std::acos((double) c)));
+  }
+  std::cout << "fast trig accuracy (" << SAMPLES << " samples)\n";
+  Report("fastSin [-2pi, 2pi]", sinErr, "");
+  Report("fastCos [-2pi, 2pi]", cosErr, "");
+  Report("fastAcos [-1, 1]   ", acosErr, "rad");
+
+  double angleAxisErr = 0.0, getAngleErr = 0.0, powErr = 0.0, slerpErr = 0.0;
+  for (int i = 0; i < SAMPLES / 10; ++i)
+  {
+    vec3 axis(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(-1, 1));
+    float a = RandomFloat(-6.28318f, 6.28318f);
+    angleAxisErr = std::fmax(angleAxisErr, QuatError(fastAngleAxis(a, axis), angleAxis(a, axis)));
+
+    quat q = RandomQuat();
+    getAngleErr = std::fmax(getAngleErr, std::fabs(fastGetAngle(q) - getAngle(q)));
+
+    float f = RandomFloat(0.0f, 1.0f);
+    powErr = std::fmax(powErr, QuatError(fastPow(q, f), q ^ f));
+
+    // slerp assumes both quats are in the same neighborhood
+    quat r = RandomQuat();
+    if (dot(q, r) < 0.0f)
+    {
+      r = -r;
+    }
+    slerpErr = std::fmax(slerpErr, QuatError(fastSlerp(q, r, f), slerp(q, r, f)));
+  }
+  Report("fastAngleAxis      ", angleAxisErr, "rad");
+  Report("fastGetAngle       ", getAngleErr, "rad");
+  Report("fastPow            ", powErr, "rad");
+  Report("fastSlerp          ", slerpErr, "rad");
+
+  std::cout << "\ncost per call (ns)\n";
+  std::cout << "sinf  " << Time(angles, [](float x) { return std::sin(x); })
+            << "\tfastSin  " << Time(angles, fastSin) << "\n";
+  std::cout << "cosf  " << Time(angles, [](float x) { return std::cos(x); })
+            << "\tfastCos  " << Time(angles, fastCos) << "\n";
+  std::cout << "acosf " << Time(cosines, [](float x) { return std::acos(x); })
+            << "\tfastAcos " << Time(cosines, fastAcos) << "\n";
+
+  quat a = RandomQuat(), b = RandomQuat();
+  if (dot(a, b) < 0.0f)
+  {
+    b = -b;
+  }
+  std::vector<float> ts(SAMPLES);
+  for (int i = 0; i < SAMPLES; ++i)
+  {
+    ts[i] = (float) i / SAMPLES;
+  }
+  std::cout << "slerp " << Time(ts, [&](float t) { return slerp(a, b, t).w; })
+            << "\tfastSlerp " << Time(ts, [&](float t) { return fastSlerp(a, b, t).w; }) << "\n";
+
+  return 0;
+}
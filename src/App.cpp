@@ -1,13 +1,21 @@
 #include "App.h"
 #include "Renderer.h"
 #include "InputSystem.h"
+#include "AssetLoader.h"
+#include "TextureLoader.h"
 
 const float SCREEN_WIDTH = 1280;
 const float SCREEN_HEIGHT = 600;
+// bytes of mesh data uploaded per frame by the asset loader
+const unsigned int ASSET_UPLOAD_BUDGET = 4 * 1024 * 1024;
+// bytes of decoded texture rows uploaded per frame
+const unsigned int TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
 
 App::App()
   :m_Renderer(nullptr)
   , m_InputSystem(nullptr)
+  , m_AssetLoader(nullptr)
+  , m_TextureLoader(nullptr)
   , m_IsRunning(true)
   , m_TicksCount(0.0f)
 {}
@@ -23,6 +31,9 @@ bool App::Initialize()
   m_InputSystem = new InputSystem();
   m_InputSystem->Initialize(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+  m_AssetLoader = new AssetLoader();
+  m_TextureLoader = new TextureLoader();
+
   return true;
 }
 
@@ -100,8 +111,16 @@ void App::UpdateApp()
 
 void App::GenerateOutput()
 {
+  // finished async loads are uploaded here, on the render thread
+  m_AssetLoader->Update(ASSET_UPLOAD_BUDGET);
+  m_TextureLoader->Update(TEXTURE_UPLOAD_BUDGET);
   m_Renderer->Draw();
 }
 
 void App::ShutDown()
-{}
+{
+  delete m_AssetLoader;
+  m_AssetLoader = nullptr;
+  delete m_TextureLoader;
+  m_TextureLoader = nullptr;
+}
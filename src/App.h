@@ -5,6 +5,8 @@ class App
 private:
   class Renderer* m_Renderer;
   class InputSystem* m_InputSystem;
+  class AssetLoader* m_AssetLoader;
+  class TextureLoader* m_TextureLoader;
   bool m_IsRunning;
   float m_TicksCount;
 public:
@@ -13,6 +15,8 @@ public:
   bool Initialize();
   void Run();
   void ShutDown();
+  class AssetLoader* GetAssetLoader() { return m_AssetLoader; }
+  class TextureLoader* GetTextureLoader() { return m_TextureLoader; }
 private:
   void ProcessInput();
   void UpdateApp();
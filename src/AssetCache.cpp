@@ -0,0 +1,288 @@
+#include "AssetCache.h"
+#include <cstring>
+#include <iostream>
+
+// **********************//
+//                       //
+//     Content hashes    //
+//                       //
+// **********************//
+
+static inline uint64_t Rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// 8 bytes at a time, a is FNV-1a style, b a multiply/rotate mix
+// with different constants. the tail is zero padded
+static void HashBytes(ContentKey& key, const void* data, size_t size)
+{
+  const unsigned char* bytes = (const unsigned char*) data;
+  uint64_t a = key.a ^ size;
+  uint64_t b = key.b + size * 0x9E3779B97F4A7C15ull;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    memcpy(&word, bytes + i, 8);
+    a = (a ^ word) * 0x100000001B3ull;
+    b = Rotl(b + word * 0xC2B2AE3D27D4EB4Full, 31) * 0x9E3779B97F4A7C15ull;
+  }
+  if (i < size)
+  {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, size - i);
+    a = (a ^ word) * 0x100000001B3ull;
+    b = Rotl(b + word * 0xC2B2AE3D27D4EB4Full, 31) * 0x9E3779B97F4A7C15ull;
+  }
+  key.a = a;
+  key.b = b;
+}
+
+static ContentKey NewKey(uint64_t type)
+{
+  ContentKey key;
+  key.a = 0xCBF29CE484222325ull ^ type;
+  key.b = 0x27D4EB2F165667C5ull + type;
+  return key;
+}
+
+template<typename T>
+static void HashVector(ContentKey& key, const std::vector<T>& v)
+{
+  HashBytes(key, v.size() > 0 ? &v[0] : 0, v.size() * sizeof(T));
+}
+
+static void HashString(ContentKey& key, const std::string& s)
+{
+  HashBytes(key, s.c_str(), s.size());
+}
+
+// fields hashed one by one, TransformA has padding
+static void HashPose(ContentKey& key, Pose& pose, size_t& bytes)
+{
+  unsigned int size = pose.Size();
+  std::vector<float> values(size * 11);
+  std::vector<int> parents(size);
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    Transform t = pose.GetLocalTransform(i);
+    float* v = &values[i * 11];
+    v[0] = t.position.x; v[1] = t.position.y; v[2] = t.position.z;
+    v[3] = t.rotation.x; v[4] = t.rotation.y; v[5] = t.rotation.z; v[6] = t.rotation.w;
+    v[7] = t.scale.x; v[8] = t.scale.y; v[9] = t.scale.z; v[10] = 0.0f;
+    parents[i] = pose.GetParent(i);
+  }
+  HashVector(key, values);
+  HashVector(key, parents);
+  bytes += size * (sizeof(TransformA) + sizeof(int));
+}
+
+template<typename T, int N>
+static void HashTrack(ContentKey& key, Track<T, N>& track, size_t& bytes)
+{
+  unsigned int size = track.Size();
+  int interpolation = (int) track.GetInterpolation();
+  HashBytes(key, &interpolation, sizeof(int));
+  HashBytes(key, size > 0 ? &track[0] : 0, size * sizeof(Frame<N>));
+  bytes += size * sizeof(Frame<N>);
+}
+
+// **********************//
+//                       //
+//         Cache         //
+//                       //
+// **********************//
+
+AssetCache::AssetCache()
+{
+  m_BytesAdded = 0;
+  m_BytesSaved = 0;
+  m_NumAdded = 0;
+  m_NumShared = 0;
+}
+
+// lookup or insert shared by the three Add functions. make is only
+// called when there is no live copy
+template<typename T, typename F>
+static std::shared_ptr<T> Intern(std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>& map,
+  std::unordered_map<ContentKey, size_t, ContentKeyHash>& sizes, const ContentKey& key, size_t bytes,
+  size_t& bytesSaved, unsigned int& numShared, F make)
+{
+  typename std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>::iterator it = map.find(key);
+  if (it != map.end())
+  {
+    std::shared_ptr<T> existing = it->second.lock();
+    if (existing)
+    {
+      bytesSaved += bytes;
+      ++numShared;
+      return existing;
+    }
+  }
+  std::shared_ptr<T> result = make();
+  map[key] = result;
+  sizes[key] = bytes;
+  return result;
+}
+
+SkeletonHandle AssetCache::Add(Skeleton& skeleton)
+{
+  ContentKey key = NewKey(1);
+  size_t bytes = 0;
+  HashPose(key, skeleton.GetRestPose(), bytes);
+  HashPose(key, skeleton.GetBindPose(), bytes);
+  std::vector<std::string>& names = skeleton.GetJointNames();
+  for (unsigned int i = 0; i < names.size(); ++i)
+  {
+    HashString(key, names[i]);
+    bytes += names[i].size() + 1;
+  }
+  bytes += skeleton.GetInvBindPose().size() * sizeof(mat4);
+
+  std::lock_guard<std::mutex> lock(m_Lock);
+  m_BytesAdded += bytes;
+  ++m_NumAdded;
+  return Intern(m_Skeletons, m_Sizes, key, bytes, m_BytesSaved, m_NumShared, [&skeleton]() {
+    return std::make_shared<Skeleton>(std::move(skeleton));
+  });
+}
+
+ClipHandle AssetCache::Add(Clip& clip)
+{
+  ContentKey key = NewKey(2);
+  size_t bytes = 0;
+  HashString(key, clip.GetName());
+  int looping = clip.GetLooping() ? 1 : 0;
+  HashBytes(key, &looping, sizeof(int));
+  for (unsigned int i = 0, size = clip.Size(); i < size; ++i)
+  {
+    unsigned int joint = clip.GetIdAtIndex(i);
+    TransformTrack& track = clip[joint];
+    HashBytes(key, &joint, sizeof(unsigned int));
+    HashTrack(key, track.GetPositionTrack(), bytes);
+    HashTrack(key, track.GetRotationTrack(), bytes);
+    HashTrack(key, track.GetScaleTrack(), bytes);
+  }
+
+  std::lock_guard<std::mutex> lock(m_Lock);
+  m_BytesAdded += bytes;
+  ++m_NumAdded;
+  return Intern(m_Clips, m_Sizes, key, bytes, m_BytesSaved, m_NumShared, [&clip]() {
+    return std::make_shared<Clip>(std::move(clip));
+  });
+}
+
+MeshHandle AssetCache::Add(Mesh& mesh)
+{
+  ContentKey key = NewKey(3);
+  HashVector(key, mesh.GetPosition());
+  HashVector(key, mesh.GetNormal());
+  HashVector(key, mesh.GetTexCoord());
+  HashVector(key, mesh.GetWeights());
+  HashVector(key, mesh.GetInfluences());
+  HashVector(key, mesh.GetIndices());
+  std::vector<MorphTarget>& targets = mesh.GetMorphTargets();
+  size_t targetBytes = 0;
+  for (unsigned int i = 0, size = (unsigned int) targets.size(); i < size; ++i)
+  {
+    HashString(key, targets[i].GetName());
+    HashVector(key, targets[i].GetRuns());
+    HashVector(key, targets[i].GetPositionDeltas());
+    HashVector(key, targets[i].GetNormalDeltas());
+    targetBytes += targets[i].GetBytes();
+  }
+  size_t bytes = targetBytes + mesh.GetPosition().size() * sizeof(vec3)
+    + mesh.GetNormal().size() * sizeof(vec3)
+    + mesh.GetTexCoord().size() * sizeof(vec2)
+    + mesh.GetWeights().size() * sizeof(vec4)
+    + mesh.GetInfluences().size() * sizeof(ivec4)
+    + mesh.GetIndices().size() * sizeof(unsigned int);
+
+  std::lock_guard<std::mutex> lock(m_Lock);
+  m_BytesAdded += bytes;
+  ++m_NumAdded;
+  // Mesh can't be moved (it owns GL buffers), the streams are
+  // swapped into the new mesh instead
+  return Intern(m_Meshes, m_Sizes, key, bytes, m_BytesSaved, m_NumShared, [&mesh]() {
+    MeshHandle result = std::make_shared<Mesh>();
+    result->GetPosition().swap(mesh.GetPosition());
+    result->GetNormal().swap(mesh.GetNormal());
+    result->GetTexCoord().swap(mesh.GetTexCoord());
+    result->GetWeights().swap(mesh.GetWeights());
+    result->GetInfluences().swap(mesh.GetInfluences());
+    // not a stream, but skinning picks its path from it
+    result->SetMaxInfluences(mesh.GetMaxInfluences());
+    result->GetIndices().swap(mesh.GetIndices());
+    result->GetMorphTargets().swap(mesh.GetMorphTargets());
+    return result;
+  });
+}
+
+size_t AssetCache::GetBytesAdded()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_BytesAdded;
+}
+
+size_t AssetCache::GetBytesSaved()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_BytesSaved;
+}
+
+template<typename T>
+static size_t LiveBytes(std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>& map,
+  std::unordered_map<ContentKey, size_t, ContentKeyHash>& sizes)
+{
+  size_t bytes = 0;
+  for (typename std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>::iterator it = map.begin(); it != map.end(); ++it)
+  {
+    if (!it->second.expired())
+    {
+      bytes += sizes[it->first];
+    }
+  }
+  return bytes;
+}
+
+size_t AssetCache::GetBytesResident()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return LiveBytes(m_Skeletons, m_Sizes) + LiveBytes(m_Clips, m_Sizes) + LiveBytes(m_Meshes, m_Sizes);
+}
+
+template<typename T>
+static void PurgeExpired(std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>& map,
+  std::unordered_map<ContentKey, size_t, ContentKeyHash>& sizes)
+{
+  for (typename std::unordered_map<ContentKey, std::weak_ptr<T>, ContentKeyHash>::iterator it = map.begin(); it != map.end();)
+  {
+    if (it->second.expired())
+    {
+      sizes.erase(it->first);
+      it = map.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void AssetCache::Purge()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  PurgeExpired(m_Skeletons, m_Sizes);
+  PurgeExpired(m_Clips, m_Sizes);
+  PurgeExpired(m_Meshes, m_Sizes);
+}
+
+void AssetCache::PrintReport()
+{
+  size_t resident = GetBytesResident();
+  std::lock_guard<std::mutex> lock(m_Lock);
+  std::cout<<"Asset cache: "<<m_NumAdded<<" added, "<<m_NumShared<<" shared, "
+    <<m_BytesAdded<<" bytes added, "<<m_BytesSaved<<" bytes saved, "
+    <<resident<<" bytes resident\n";
+}
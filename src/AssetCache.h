@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Skeleton.h"
+#include "Clip.h"
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// reference counted handles to shared, resident asset data
+// the data is freed when the last handle goes away
+typedef std::shared_ptr<Skeleton> SkeletonHandle;
+typedef std::shared_ptr<Clip> ClipHandle;
+typedef std::shared_ptr<Mesh> MeshHandle;
+
+// 128 bit content hash, two independent 64 bit hashes so a
+// collision would need both to collide at once
+struct ContentKey
+{
+  uint64_t a;
+  uint64_t b;
+  bool operator==(const ContentKey& other) const { return a == other.a && b == other.b; }
+};
+
+struct ContentKeyHash
+{
+  size_t operator()(const ContentKey& key) const { return (size_t) (key.a ^ (key.b * 31)); }
+};
+
+class AssetCache {
+  // content addressed registry for imported data. Add hashes a
+  // skeleton, clip or mesh by content, returns the resident copy if
+  // one with the same content is still alive, otherwise keeps the
+  // new one. entries are weak, the cache never keeps data alive
+  // thread safe, workers can add while the render thread reads
+  // sharing is per whole skeleton, clip (all of its tracks) or mesh
+  // (all of its vertex streams), those own their arrays by value
+protected:
+  std::unordered_map<ContentKey, std::weak_ptr<Skeleton>, ContentKeyHash> m_Skeletons;
+  std::unordered_map<ContentKey, std::weak_ptr<Clip>, ContentKeyHash> m_Clips;
+  std::unordered_map<ContentKey, std::weak_ptr<Mesh>, ContentKeyHash> m_Meshes;
+  std::unordered_map<ContentKey, size_t, ContentKeyHash> m_Sizes;
+  std::mutex m_Lock;
+  size_t m_BytesAdded;
+  size_t m_BytesSaved;
+  unsigned int m_NumAdded;
+  unsigned int m_NumShared;
+
+public:
+  AssetCache();
+  // a new object is moved into the cache, use the returned handle
+  // afterwards. the argument is left alone when a copy exists
+  SkeletonHandle Add(Skeleton& skeleton);
+  ClipHandle Add(Clip& clip);
+  // CPU meshes only, hash needs the vertex streams. a returned
+  // existing mesh may already be uploaded (HasGPUData)
+  MeshHandle Add(Mesh& mesh);
+
+  // bytes of every Add call, and the part of that served by an
+  // existing copy instead of being kept
+  size_t GetBytesAdded();
+  size_t GetBytesSaved();
+  // bytes held by entries that are still alive
+  size_t GetBytesResident();
+  // drops expired entries
+  void Purge();
+  void PrintReport();
+
+private:
+  AssetCache(const AssetCache& other);
+  AssetCache& operator=(const AssetCache& other);
+};
@@ -0,0 +1,285 @@
+#include "AssetLoader.h"
+#include "GLTFLoader.h"
+
+static void SetState(AssetRequest& request, AssetState state)
+{
+  {
+    std::lock_guard<std::mutex> lock(request.lock);
+    request.state = (int) state;
+  }
+  request.done.notify_all();
+}
+
+AssetHandle::AssetHandle() {}
+
+AssetHandle::AssetHandle(const std::shared_ptr<AssetRequest>& request)
+  : m_Request(request) {}
+
+bool AssetHandle::IsValid() const
+{
+  return m_Request != nullptr;
+}
+
+AssetState AssetHandle::GetState() const
+{
+  return m_Request ? (AssetState) m_Request->state.load() : AssetState::Failed;
+}
+
+bool AssetHandle::IsReady() const
+{
+  return GetState() == AssetState::Ready;
+}
+
+bool AssetHandle::IsFailed() const
+{
+  return GetState() == AssetState::Failed;
+}
+
+void AssetHandle::Wait() const
+{
+  if (!m_Request)
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(m_Request->lock);
+  m_Request->done.wait(lock, [this]() {
+    return m_Request->state.load() >= (int) AssetState::Uploading;
+  });
+}
+
+LoadedAsset* AssetHandle::Get() const
+{
+  return IsReady() ? &m_Request->asset : 0;
+}
+
+std::shared_ptr<AssetRequest>& AssetHandle::GetRequest()
+{
+  return m_Request;
+}
+
+AssetLoader::AssetLoader(unsigned int numThreads)
+{
+  m_Stopping = false;
+  m_Importing = 0;
+  if (numThreads == 0)
+  {
+    unsigned int cores = std::thread::hardware_concurrency();
+    numThreads = cores > 1 ? cores - 1 : 1;
+  }
+  m_Workers.reserve(numThreads);
+  for (unsigned int i = 0; i < numThreads; ++i)
+  {
+    m_Workers.push_back(std::thread(&AssetLoader::WorkerLoop, this));
+  }
+}
+
+// queued files are dropped and marked failed, files being imported
+// finish first. anything not uploaded yet is never uploaded
+AssetLoader::~AssetLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    m_Stopping = true;
+    for (unsigned int i = 0; i < m_Queue.size(); ++i)
+    {
+      SetState(*m_Queue[i], AssetState::Failed);
+    }
+    m_Queue.clear();
+  }
+  m_QueueSignal.notify_all();
+  for (unsigned int i = 0; i < m_Workers.size(); ++i)
+  {
+    m_Workers[i].join();
+  }
+}
+
+AssetHandle AssetLoader::Load(const std::string& path, bool keepCPUData, uint64_t checksum)
+{
+  std::shared_ptr<AssetRequest> request = std::make_shared<AssetRequest>();
+  request->asset.path = path;
+  request->keepCPUData = keepCPUData;
+  request->checksum = checksum;
+  request->nextMesh = 0;
+  request->state = (int) AssetState::Queued;
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    m_Queue.push_back(request);
+  }
+  m_QueueSignal.notify_one();
+  return AssetHandle(request);
+}
+
+std::vector<AssetHandle> AssetLoader::Load(const std::vector<std::string>& paths, bool keepCPUData)
+{
+  std::vector<AssetHandle> result;
+  result.reserve(paths.size());
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    for (unsigned int i = 0; i < paths.size(); ++i)
+    {
+      std::shared_ptr<AssetRequest> request = std::make_shared<AssetRequest>();
+      request->asset.path = paths[i];
+      request->keepCPUData = keepCPUData;
+      request->checksum = 0;
+      request->nextMesh = 0;
+      request->state = (int) AssetState::Queued;
+      m_Queue.push_back(request);
+      result.push_back(AssetHandle(request));
+    }
+  }
+  m_QueueSignal.notify_all();
+  return result;
+}
+
+void AssetLoader::WorkerLoop()
+{
+  for (;;)
+  {
+    std::shared_ptr<AssetRequest> request;
+    {
+      std::unique_lock<std::mutex> lock(m_QueueLock);
+      m_QueueSignal.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+      if (m_Stopping)
+      {
+        return;
+      }
+      request = m_Queue.front();
+      m_Queue.pop_front();
+      ++m_Importing;
+    }
+    Import(std::move(request));
+    --m_Importing;
+  }
+}
+
+// runs on a worker, nothing in here may call GL. request is taken
+// by value and moved into the upload queue so the worker never holds
+// the last reference to uploaded meshes (their GL buffers have to
+// be deleted on the render thread)
+void AssetLoader::Import(std::shared_ptr<AssetRequest> request)
+{
+  SetState(*request, AssetState::Loading);
+  LoadedAsset& asset = request->asset;
+  cgltf_data* data = LoadTrustedGLTFFile(asset.path.c_str(), request->checksum, true, &asset.report);
+  if (data == 0)
+  {
+    SetState(*request, AssetState::Failed);
+    return;
+  }
+  asset.skeleton = LoadSkeleton(data);
+  asset.clips = LoadAnimationClips(data);
+  asset.clipTable = MakeClipTable(asset.clips);
+  asset.meshes = LoadCPUMeshes(data);
+  FreeGLTTFile(data);
+
+  if (asset.meshes.size() == 0)
+  {
+    SetState(*request, AssetState::Ready);
+    return;
+  }
+  // state first, once queued the render thread may finish it
+  SetState(*request, AssetState::Uploading);
+  std::lock_guard<std::mutex> lock(m_UploadLock);
+  m_Uploads.push_back(std::move(request));
+}
+
+static unsigned int MeshBytes(Mesh& mesh)
+{
+  return (unsigned int) (mesh.GetPosition().size() * sizeof(vec3)
+    + mesh.GetNormal().size() * sizeof(vec3)
+    + mesh.GetTexCoord().size() * sizeof(vec2)
+    + mesh.GetWeights().size() * sizeof(vec4)
+    + mesh.GetInfluences().size() * sizeof(ivec4)
+    + mesh.GetIndices().size() * sizeof(unsigned int));
+}
+
+unsigned int AssetLoader::Upload(AssetRequest& request, unsigned int budget)
+{
+  unsigned int used = 0;
+  std::vector<Mesh>& meshes = request.asset.meshes;
+  unsigned int numMeshes = (unsigned int) meshes.size();
+  while (request.nextMesh < numMeshes && used < budget)
+  {
+    Mesh& mesh = meshes[request.nextMesh++];
+    used += MeshBytes(mesh);
+    mesh.UpdateOpenGLBuffers();
+    if (!request.keepCPUData)
+    {
+      mesh.ReleaseCPUData();
+    }
+  }
+  if (request.nextMesh >= numMeshes)
+  {
+    SetState(request, AssetState::Ready);
+  }
+  return used;
+}
+
+void AssetLoader::Update(unsigned int uploadBudgetBytes)
+{
+  // the budget is at least 1 so the first mesh always goes through
+  unsigned int budget = uploadBudgetBytes > 0 ? uploadBudgetBytes : 1;
+  unsigned int used = 0;
+  while (used < budget)
+  {
+    std::shared_ptr<AssetRequest> request;
+    {
+      std::lock_guard<std::mutex> lock(m_UploadLock);
+      if (m_Uploads.empty())
+      {
+        return;
+      }
+      request = m_Uploads.front();
+    }
+    used += Upload(*request, budget - used);
+    if (request->state.load() != (int) AssetState::Ready)
+    {
+      // budget ran out part way through this asset
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_UploadLock);
+    m_Uploads.pop_front();
+  }
+}
+
+void AssetLoader::Finish(AssetHandle& handle)
+{
+  if (!handle.IsValid())
+  {
+    return;
+  }
+  handle.Wait();
+  std::shared_ptr<AssetRequest>& request = handle.GetRequest();
+  if (request->state.load() != (int) AssetState::Uploading)
+  {
+    return;
+  }
+  Upload(*request, ~0u);
+  std::lock_guard<std::mutex> lock(m_UploadLock);
+  for (std::deque<std::shared_ptr<AssetRequest>>::iterator it = m_Uploads.begin(); it != m_Uploads.end(); ++it)
+  {
+    if (*it == request)
+    {
+      m_Uploads.erase(it);
+      break;
+    }
+  }
+}
+
+// files not Ready or Failed yet. requests only move forward, queue ->
+// importing -> uploads, so counting in that order can count one twice
+// but never miss one (uploads are only removed on this thread)
+unsigned int AssetLoader::GetPendingCount()
+{
+  unsigned int pending = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    pending += (unsigned int) m_Queue.size();
+  }
+  pending += m_Importing.load();
+  {
+    std::lock_guard<std::mutex> lock(m_UploadLock);
+    pending += (unsigned int) m_Uploads.size();
+  }
+  return pending;
+}
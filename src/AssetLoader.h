@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Skeleton.h"
+#include "Clip.h"
+#include "Mesh.h"
+#include "GLTFLoader.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// everything imported from one glTF/GLB file
+struct LoadedAsset
+{
+  std::string path;
+  Skeleton skeleton;
+  std::vector<Clip> clips;
+  // clip name -> index into clips
+  NameTable clipTable;
+  std::vector<Mesh> meshes;
+  // timings of parse, buffers and validation on the worker
+  GLTFLoadReport report;
+};
+
+enum class AssetState {
+  Queued
+  , Loading   // parse, buffers, validate and import on a worker
+  , Uploading // imported, waiting for GL uploads on the render thread
+  , Ready
+  , Failed
+};
+
+struct AssetRequest
+{
+  LoadedAsset asset;
+  bool keepCPUData;
+  uint64_t checksum;
+  unsigned int nextMesh;
+  std::atomic<int> state;
+  std::mutex lock;
+  std::condition_variable done;
+};
+
+class AssetHandle {
+  // shared view of a load request, cheap to copy. can be polled from
+  // any thread, the asset itself is only usable once Ready
+protected:
+  std::shared_ptr<AssetRequest> m_Request;
+
+public:
+  AssetHandle();
+  AssetHandle(const std::shared_ptr<AssetRequest>& request);
+  bool IsValid() const;
+  AssetState GetState() const;
+  bool IsReady() const;
+  bool IsFailed() const;
+  // blocks until the worker is done with the file (Uploading,
+  // Ready or Failed). uploads still need AssetLoader::Update or Finish
+  void Wait() const;
+  // 0 until Ready
+  LoadedAsset* Get() const;
+  std::shared_ptr<AssetRequest>& GetRequest();
+};
+
+class AssetLoader {
+  // loads many files in parallel: a pool of worker threads does
+  // parse, buffer loading, validation and import, then the render
+  // thread uploads meshes in Update within a per frame byte budget
+  // GL is never touched off the render thread
+protected:
+  std::vector<std::thread> m_Workers;
+  std::deque<std::shared_ptr<AssetRequest>> m_Queue;
+  std::mutex m_QueueLock;
+  std::condition_variable m_QueueSignal;
+  bool m_Stopping;
+  std::atomic<unsigned int> m_Importing;
+
+  std::deque<std::shared_ptr<AssetRequest>> m_Uploads;
+  std::mutex m_UploadLock;
+
+protected:
+  void WorkerLoop();
+  void Import(std::shared_ptr<AssetRequest> request);
+  // returns bytes uploaded, stops once budget is used up
+  unsigned int Upload(AssetRequest& request, unsigned int budget);
+
+public:
+  // 0 threads = one per core, minus the render thread
+  AssetLoader(unsigned int numThreads = 0);
+  ~AssetLoader();
+
+  // a non zero checksum loads the file as trusted (LoadTrustedGLTFFile)
+  AssetHandle Load(const std::string& path, bool keepCPUData = false, uint64_t checksum = 0);
+  std::vector<AssetHandle> Load(const std::vector<std::string>& paths, bool keepCPUData = false);
+
+  // render thread: upload finished imports, at least one mesh per
+  // call so big meshes can't stall the queue
+  void Update(unsigned int uploadBudgetBytes);
+  // render thread: wait for one asset and upload it right away
+  void Finish(AssetHandle& handle);
+  unsigned int GetPendingCount();
+
+private:
+  AssetLoader(const AssetLoader& other);
+  AssetLoader& operator=(const AssetLoader& other);
+};
@@ -1,5 +1,7 @@
 #include "Attribute.h"
 #include "Math.h"
+#include "Half.h"
+#include "Quantize.h"
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 
@@ -8,6 +10,15 @@ template Attribute<float>;
 template Attribute<vec2>;
 template Attribute<vec3>;
 template Attribute<vec4>;
+template Attribute<ivec4>;
+template Attribute<half>;
+template Attribute<hvec3>;
+template Attribute<hquat>;
+template Attribute<hvec2>;
+template Attribute<snorm16x4>;
+template Attribute<snorm16x2>;
+template Attribute<ubyte4>;
+template Attribute<unorm8x4>;
 
 template<typename T>
 Attribute<T>::Attribute()
@@ -52,6 +63,50 @@ void Attribute<vec4>::SetAttribPointer(unsigned int slot)
 {
   glVertexAttribPointer(slot, 4, GL_FLOAT, GL_FALSE, 0, 0);
 }
+// half precision attributes are read as floats by the shader
+template<>
+void Attribute<half>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 1, GL_HALF_FLOAT, GL_FALSE, 0, 0);
+}
+template<>
+void Attribute<hvec3>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 3, GL_HALF_FLOAT, GL_FALSE, 0, 0);
+}
+template<>
+void Attribute<hquat>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 4, GL_HALF_FLOAT, GL_FALSE, 0, 0);
+}
+
+template<>
+void Attribute<hvec2>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 2, GL_HALF_FLOAT, GL_FALSE, 0, 0);
+}
+// packed attributes (Quantize.h). normalized ones arrive in the shader
+// as floats in [-1, 1] or [0, 1], the joint bytes as integers
+template<>
+void Attribute<snorm16x4>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 4, GL_SHORT, GL_TRUE, 0, 0);
+}
+template<>
+void Attribute<snorm16x2>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 2, GL_SHORT, GL_TRUE, 0, 0);
+}
+template<>
+void Attribute<ubyte4>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribIPointer(slot, 4, GL_UNSIGNED_BYTE, 0, (void*) 0);
+}
+template<>
+void Attribute<unorm8x4>::SetAttribPointer(unsigned int slot)
+{
+  glVertexAttribPointer(slot, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+}
 
 template<typename T>
 void Attribute<T>::Set(T* inputArray, unsigned int arrayLength)
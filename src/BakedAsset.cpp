@@ -0,0 +1,522 @@
+#include "BakedAsset.h"
+#include "MeshOptimizer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BAKED_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// **********************//
+//                       //
+//        Writing        //
+//                       //
+// **********************//
+
+// the file is built in memory, structs are reserved first and
+// filled in by offset since the byte array moves as it grows
+struct BakeWriter
+{
+  std::vector<unsigned char> m_Bytes;
+
+  uint64_t Reserve(size_t size)
+  {
+    size_t offset = (m_Bytes.size() + 15) & ~(size_t) 15;
+    m_Bytes.resize(offset + size, 0);
+    return offset;
+  }
+
+  uint64_t Write(const void* data, size_t size)
+  {
+    if (data == 0 || size == 0)
+    {
+      return 0;
+    }
+    uint64_t offset = Reserve(size);
+    memcpy(&m_Bytes[offset], data, size);
+    return offset;
+  }
+
+  template<typename T>
+  T* At(uint64_t offset)
+  {
+    return (T*) &m_Bytes[offset];
+  }
+};
+
+template<typename T>
+static uint64_t WriteArray(BakeWriter& writer, std::vector<T>& v)
+{
+  return v.size() > 0 ? writer.Write(&v[0], v.size() * sizeof(T)) : 0;
+}
+
+static uint64_t WriteString(BakeWriter& writer, const std::string& s)
+{
+  return writer.Write(s.c_str(), s.size() + 1);
+}
+
+static uint64_t WritePose(BakeWriter& writer, Pose& pose)
+{
+  unsigned int numJoints = pose.Size();
+  std::vector<TransformA> joints(numJoints);
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    joints[i] = toTransformA(pose.GetLocalTransform(i));
+  }
+  return WriteArray(writer, joints);
+}
+
+template<typename T, int N>
+static void WriteTrack(BakeWriter& writer, uint64_t trackOffset, Track<T, N>& track,
+  unsigned int joint, BakedComponent component)
+{
+  uint64_t frames = writer.Write(&track[0], track.Size() * sizeof(Frame<N>));
+  BakedTrack* baked = writer.At<BakedTrack>(trackOffset);
+  baked->joint = joint;
+  baked->component = (uint32_t) component;
+  baked->interpolation = (uint32_t) track.GetInterpolation();
+  baked->numFrames = track.Size();
+  baked->frames.offset = frames;
+}
+
+bool SaveBakedFile(const char* path, Skeleton& skeleton, std::vector<Clip>& clips, std::vector<Mesh>& meshes)
+{
+  BakeWriter writer;
+  unsigned int numClips = (unsigned int) clips.size();
+  unsigned int numMeshes = (unsigned int) meshes.size();
+
+  uint64_t header = writer.Reserve(sizeof(BakedHeader));
+  uint64_t skel = writer.Reserve(sizeof(BakedSkeleton));
+  uint64_t clipArray = numClips > 0 ? writer.Reserve(sizeof(BakedClip) * numClips) : 0;
+  uint64_t meshArray = numMeshes > 0 ? writer.Reserve(sizeof(BakedMesh) * numMeshes) : 0;
+
+  // skeleton
+  unsigned int numJoints = skeleton.Size();
+  std::vector<int32_t> parents(numJoints);
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    parents[i] = skeleton.GetRestPose().GetParent(i);
+  }
+  uint64_t restPose = WritePose(writer, skeleton.GetRestPose());
+  uint64_t bindPose = WritePose(writer, skeleton.GetBindPose());
+  uint64_t parentArray = WriteArray(writer, parents);
+  uint64_t nameArray = numJoints > 0 ? writer.Reserve(sizeof(BakedPtr<char>) * numJoints) : 0;
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    uint64_t name = WriteString(writer, skeleton.GetJointName(i));
+    writer.At<BakedPtr<char>>(nameArray)[i].offset = name;
+  }
+  BakedSkeleton* bakedSkeleton = writer.At<BakedSkeleton>(skel);
+  bakedSkeleton->numJoints = numJoints;
+  bakedSkeleton->restPose.offset = restPose;
+  bakedSkeleton->bindPose.offset = bindPose;
+  bakedSkeleton->parents.offset = parentArray;
+  bakedSkeleton->names.offset = nameArray;
+
+  // clips, only component tracks that have frames are written
+  for (unsigned int c = 0; c < numClips; ++c)
+  {
+    Clip& clip = clips[c];
+    unsigned int numTracks = 0;
+    for (unsigned int t = 0, size = clip.Size(); t < size; ++t)
+    {
+      TransformTrack& track = clip[clip.GetIdAtIndex(t)];
+      numTracks += (track.GetPositionTrack().Size() > 0 ? 1 : 0)
+                 + (track.GetRotationTrack().Size() > 0 ? 1 : 0)
+                 + (track.GetScaleTrack().Size() > 0 ? 1 : 0);
+    }
+    uint64_t name = WriteString(writer, clip.GetName());
+    uint64_t trackArray = numTracks > 0 ? writer.Reserve(sizeof(BakedTrack) * numTracks) : 0;
+    uint64_t next = trackArray;
+    for (unsigned int t = 0, size = clip.Size(); t < size; ++t)
+    {
+      unsigned int joint = clip.GetIdAtIndex(t);
+      TransformTrack& track = clip[joint];
+      if (track.GetPositionTrack().Size() > 0)
+      {
+        WriteTrack(writer, next, track.GetPositionTrack(), joint, BakedPosition);
+        next += sizeof(BakedTrack);
+      }
+      if (track.GetRotationTrack().Size() > 0)
+      {
+        WriteTrack(writer, next, track.GetRotationTrack(), joint, BakedRotation);
+        next += sizeof(BakedTrack);
+      }
+      if (track.GetScaleTrack().Size() > 0)
+      {
+        WriteTrack(writer, next, track.GetScaleTrack(), joint, BakedScale);
+        next += sizeof(BakedTrack);
+      }
+    }
+    BakedClip* bakedClip = writer.At<BakedClip>(clipArray) + c;
+    bakedClip->name.offset = name;
+    bakedClip->tracks.offset = trackArray;
+    bakedClip->numTracks = numTracks;
+    bakedClip->looping = clip.GetLooping() ? 1 : 0;
+  }
+
+  // meshes, streams the source didn't have stay null
+  for (unsigned int m = 0; m < numMeshes; ++m)
+  {
+    Mesh& mesh = meshes[m];
+    uint64_t position = WriteArray(writer, mesh.GetPosition());
+    uint64_t normal = WriteArray(writer, mesh.GetNormal());
+    uint64_t texCoord = WriteArray(writer, mesh.GetTexCoord());
+    uint64_t weights = WriteArray(writer, mesh.GetWeights());
+    uint64_t influences = WriteArray(writer, mesh.GetInfluences());
+    uint64_t indices = WriteArray(writer, mesh.GetIndices());
+    BakedMesh* bakedMesh = writer.At<BakedMesh>(meshArray) + m;
+    bakedMesh->numVerts = (uint32_t) mesh.GetPosition().size();
+    bakedMesh->numIndices = (uint32_t) mesh.GetIndices().size();
+    bakedMesh->position.offset = position;
+    bakedMesh->normal.offset = normal;
+    bakedMesh->texCoord.offset = texCoord;
+    bakedMesh->weights.offset = weights;
+    bakedMesh->influences.offset = influences;
+    bakedMesh->indices.offset = indices;
+  }
+
+  // pad the end so the last block is a multiple of 16 too
+  writer.Reserve(0);
+  BakedHeader* bakedHeader = writer.At<BakedHeader>(header);
+  bakedHeader->magic = BAKED_MAGIC;
+  bakedHeader->version = BAKED_VERSION;
+  bakedHeader->fileSize = writer.m_Bytes.size();
+  bakedHeader->numClips = numClips;
+  bakedHeader->numMeshes = numMeshes;
+  bakedHeader->skeleton.offset = skel;
+  bakedHeader->clips.offset = clipArray;
+  bakedHeader->meshes.offset = meshArray;
+
+  FILE* file = fopen(path, "wb");
+  if (file == 0)
+  {
+    std::cout<<"Could not write:"<<path<<"\n";
+    return false;
+  }
+  size_t written = fwrite(&writer.m_Bytes[0], 1, writer.m_Bytes.size(), file);
+  fclose(file);
+  if (written != writer.m_Bytes.size())
+  {
+    std::cout<<"Could not write:"<<path<<"\n";
+    return false;
+  }
+  return true;
+}
+
+// **********************//
+//                       //
+//        Loading        //
+//                       //
+// **********************//
+
+// offset -> pointer for count elements, fails if they would run
+// past the end of the file. a 0 offset is a null pointer, only
+// allowed for an empty array unless the array is optional
+template<typename T>
+static bool Fixup(BakedPtr<T>& p, unsigned char* base, uint64_t fileSize, uint64_t count,
+  bool optional = false)
+{
+  if (p.offset == 0)
+  {
+    p.ptr = 0;
+    return count == 0 || optional;
+  }
+  if (p.offset % 16 != 0 || p.offset > fileSize || count * sizeof(T) > fileSize - p.offset)
+  {
+    return false;
+  }
+  p.ptr = (T*) (base + p.offset);
+  return true;
+}
+
+static bool FixupString(BakedPtr<char>& p, unsigned char* base, uint64_t fileSize)
+{
+  if (p.offset == 0 || p.offset % 16 != 0 || p.offset >= fileSize)
+  {
+    return false;
+  }
+  if (memchr(base + p.offset, 0, (size_t) (fileSize - p.offset)) == 0)
+  {
+    return false;
+  }
+  p.ptr = (char*) (base + p.offset);
+  return true;
+}
+
+static bool FixupFile(BakedHeader* header)
+{
+  unsigned char* base = (unsigned char*) header;
+  uint64_t size = header->fileSize;
+
+  if (!Fixup(header->skeleton, base, size, 1) || header->skeleton.ptr == 0)
+  {
+    return false;
+  }
+  BakedSkeleton& skeleton = *header->skeleton.ptr;
+  unsigned int numJoints = skeleton.numJoints;
+  if (!Fixup(skeleton.restPose, base, size, numJoints)
+   || !Fixup(skeleton.bindPose, base, size, numJoints)
+   || !Fixup(skeleton.parents, base, size, numJoints)
+   || !Fixup(skeleton.names, base, size, numJoints))
+  {
+    return false;
+  }
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    if (!FixupString(skeleton.names.ptr[i], base, size))
+    {
+      return false;
+    }
+    // parents come before their children, global transforms and
+    // palettes are built in one pass relying on it
+    int parent = skeleton.parents.ptr[i];
+    if (parent != -1 && (parent < 0 || parent >= (int) i))
+    {
+      return false;
+    }
+  }
+
+  if (!Fixup(header->clips, base, size, header->numClips))
+  {
+    return false;
+  }
+  for (unsigned int c = 0; c < header->numClips; ++c)
+  {
+    BakedClip& clip = header->clips.ptr[c];
+    if (!FixupString(clip.name, base, size) || !Fixup(clip.tracks, base, size, clip.numTracks))
+    {
+      return false;
+    }
+    for (unsigned int t = 0; t < clip.numTracks; ++t)
+    {
+      BakedTrack& track = clip.tracks.ptr[t];
+      unsigned int floatsPerFrame = (unsigned int) (track.component == BakedRotation
+        ? sizeof(Frame<4>) : sizeof(Frame<3>)) / sizeof(float);
+      if (track.component > BakedScale || track.joint >= numJoints
+       || track.interpolation > (uint32_t) Interpolation::Cubic
+       || !Fixup(track.frames, base, size, (uint64_t) track.numFrames * floatsPerFrame))
+      {
+        return false;
+      }
+    }
+  }
+
+  if (!Fixup(header->meshes, base, size, header->numMeshes))
+  {
+    return false;
+  }
+  for (unsigned int m = 0; m < header->numMeshes; ++m)
+  {
+    BakedMesh& mesh = header->meshes.ptr[m];
+    // positions and indices are required, the other streams may be
+    // missing (null) like they can be in a glTF
+    if (!Fixup(mesh.position, base, size, mesh.numVerts)
+     || !Fixup(mesh.normal, base, size, mesh.numVerts, true)
+     || !Fixup(mesh.texCoord, base, size, mesh.numVerts, true)
+     || !Fixup(mesh.weights, base, size, mesh.numVerts, true)
+     || !Fixup(mesh.influences, base, size, mesh.numVerts, true)
+     || !Fixup(mesh.indices, base, size, mesh.numIndices))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the mapping is private and writable: fixing up offsets only
+// copies the pages holding the small structs, the big arrays stay
+// shared with the page cache
+BakedHeader* LoadBakedFile(const char* path)
+{
+  void* memory = 0;
+  size_t length = 0;
+#ifdef BAKED_MMAP
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0)
+  {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      length = (size_t) info.st_size;
+      memory = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (memory == MAP_FAILED)
+      {
+        memory = 0;
+      }
+    }
+    close(fd);
+  }
+#else
+  FILE* file = fopen(path, "rb");
+  if (file != 0)
+  {
+    fseek(file, 0, SEEK_END);
+    long fileLength = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileLength > 0)
+    {
+      length = (size_t) fileLength;
+      memory = malloc(length);
+      if (memory != 0 && fread(memory, 1, length, file) != length)
+      {
+        free(memory);
+        memory = 0;
+      }
+    }
+    fclose(file);
+  }
+#endif
+  if (memory == 0)
+  {
+    std::cout<<"Could not load:"<<path<<"\n";
+    return 0;
+  }
+
+  BakedHeader* header = (BakedHeader*) memory;
+  bool valid = length >= sizeof(BakedHeader)
+    && header->magic == BAKED_MAGIC
+    && header->version == BAKED_VERSION
+    && header->fileSize == length;
+  if (!valid || !FixupFile(header))
+  {
+    std::cout<<"Invalid baked file:"<<path<<"\n";
+#ifdef BAKED_MMAP
+    munmap(memory, length);
+#else
+    free(memory);
+#endif
+    return 0;
+  }
+  return header;
+}
+
+void FreeBakedFile(BakedHeader* file)
+{
+  if (file == 0)
+  {
+    std::cout<<"WARNING: Can't free null data\n";
+    return;
+  }
+#ifdef BAKED_MMAP
+  munmap(file, (size_t) file->fileSize);
+#else
+  free(file);
+#endif
+}
+
+Skeleton LoadSkeleton(BakedHeader* file)
+{
+  BakedSkeleton& baked = *file->skeleton.ptr;
+  unsigned int numJoints = baked.numJoints;
+  Pose rest;
+  Pose bind;
+  rest.Set(baked.restPose.ptr, baked.parents.ptr, numJoints);
+  bind.Set(baked.bindPose.ptr, baked.parents.ptr, numJoints);
+  std::vector<std::string> names;
+  names.reserve(numJoints);
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    names.push_back(baked.names.ptr[i].ptr);
+  }
+  return Skeleton(rest, bind, names);
+}
+
+static void ClipFromBaked(Clip& clip, BakedClip& baked)
+{
+  clip.SetName(baked.name.ptr);
+  clip.SetLooping(baked.looping != 0);
+  clip.Reserve(baked.numTracks);
+  for (unsigned int t = 0; t < baked.numTracks; ++t)
+  {
+    BakedTrack& track = baked.tracks.ptr[t];
+    TransformTrack& transformTrack = clip[track.joint];
+    Interpolation interpolation = (Interpolation) track.interpolation;
+    if (track.component == BakedPosition)
+    {
+      transformTrack.GetPositionTrack().Set((const Frame<3>*) track.frames.ptr, track.numFrames);
+      transformTrack.GetPositionTrack().SetInterpolation(interpolation);
+    }
+    else if (track.component == BakedRotation)
+    {
+      transformTrack.GetRotationTrack().Set((const Frame<4>*) track.frames.ptr, track.numFrames);
+      transformTrack.GetRotationTrack().SetInterpolation(interpolation);
+    }
+    else
+    {
+      transformTrack.GetScaleTrack().Set((const Frame<3>*) track.frames.ptr, track.numFrames);
+      transformTrack.GetScaleTrack().SetInterpolation(interpolation);
+    }
+  }
+  clip.RecalculateDuration();
+}
+
+std::vector<Clip> LoadAnimationClips(BakedHeader* file)
+{
+  unsigned int numClips = file->numClips;
+  std::vector<Clip> result(numClips);
+  for (unsigned int c = 0; c < numClips; ++c)
+  {
+    ClipFromBaked(result[c], file->clips.ptr[c]);
+  }
+  return result;
+}
+
+Clip LoadAnimationClip(BakedHeader* file, unsigned int index)
+{
+  Clip result;
+  if (index >= file->numClips)
+  {
+    std::cout<<"Baked clip index out of range: "<<index<<"\n";
+    return result;
+  }
+  ClipFromBaked(result, file->clips.ptr[index]);
+  return result;
+}
+
+template<typename T>
+static void CopyStream(std::vector<T>& out, const T* in, unsigned int count)
+{
+  if (in != 0)
+  {
+    out.assign(in, in + count);
+  }
+}
+
+std::vector<Mesh> LoadMeshes(BakedHeader* file, bool keepCPUData)
+{
+  unsigned int numMeshes = file->numMeshes;
+  std::vector<Mesh> result(numMeshes);
+  for (unsigned int m = 0; m < numMeshes; ++m)
+  {
+    BakedMesh& baked = file->meshes.ptr[m];
+    Mesh& mesh = result[m];
+    // not stored in the file, one pass over the mapped weights. the
+    // baker already sorted them (version 2), only the count is needed
+    if (baked.weights.ptr != 0)
+    {
+      mesh.SetMaxInfluences(CountMaxInfluences(baked.weights.ptr, baked.numVerts));
+    }
+    if (!keepCPUData)
+    {
+      mesh.UploadStreams(baked.position.ptr, baked.normal.ptr, baked.texCoord.ptr,
+        baked.weights.ptr, baked.influences.ptr, baked.numVerts,
+        baked.indices.ptr, baked.numIndices);
+      continue;
+    }
+    CopyStream(mesh.GetPosition(), baked.position.ptr, baked.numVerts);
+    CopyStream(mesh.GetNormal(), baked.normal.ptr, baked.numVerts);
+    CopyStream(mesh.GetTexCoord(), baked.texCoord.ptr, baked.numVerts);
+    CopyStream(mesh.GetWeights(), baked.weights.ptr, baked.numVerts);
+    CopyStream(mesh.GetInfluences(), baked.influences.ptr, baked.numVerts);
+    CopyStream(mesh.GetIndices(), baked.indices.ptr, baked.numIndices);
+    mesh.UpdateOpenGLBuffers();
+  }
+  return result;
+}
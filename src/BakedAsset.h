@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Skeleton.h"
+#include "Clip.h"
+#include "Mesh.h"
+#include <cstdint>
+#include <vector>
+
+// baked asset files: skeleton, clips and meshes written out offline
+// (tools/AssetBaker.cpp, make assetbaker) in the same layout the runtime
+// uses, so loading is a mmap plus turning offsets into pointers
+//
+// layout, every block 16 byte aligned:
+//   BakedHeader
+//   BakedSkeleton
+//   BakedClip[numClips]    BakedTrack[] per clip
+//   BakedMesh[numMeshes]
+//   data: joint/track frame/vertex arrays and names
+//
+// every BakedPtr holds a byte offset from the start of the file
+// (0 = none) until LoadBakedFile fixes it up into a pointer
+// bump BAKED_VERSION whenever any of the structs below change, or
+// what the data in them means
+// version 2: mesh weights are sorted biggest first (LimitInfluences),
+// skinning relies on that for meshes under 4 influences
+
+#define BAKED_MAGIC 0x4B424E41 // "ANBK"
+#define BAKED_VERSION 2
+
+template<typename T>
+union BakedPtr
+{
+  uint64_t offset;
+  T* ptr;
+};
+static_assert(sizeof(BakedPtr<char>) == 8, "BakedPtr must be 8 bytes");
+
+struct BakedTrack
+{
+  uint32_t joint;
+  uint32_t component; // BakedComponent
+  uint32_t interpolation; // Interpolation
+  uint32_t numFrames;
+  // Frame<3> for position and scale, Frame<4> for rotation
+  BakedPtr<float> frames;
+};
+
+enum BakedComponent
+{
+  BakedPosition = 0
+  , BakedRotation
+  , BakedScale
+};
+
+struct BakedClip
+{
+  BakedPtr<char> name;
+  BakedPtr<BakedTrack> tracks;
+  uint32_t numTracks;
+  uint32_t looping;
+};
+
+struct BakedSkeleton
+{
+  uint32_t numJoints;
+  uint32_t pad;
+  BakedPtr<TransformA> restPose;
+  BakedPtr<TransformA> bindPose;
+  BakedPtr<int32_t> parents;
+  // numJoints names, each null terminated
+  BakedPtr<BakedPtr<char>> names;
+};
+
+// null streams are missing from the source mesh, position and
+// indices never are (unless the mesh is empty)
+struct BakedMesh
+{
+  uint32_t numVerts;
+  uint32_t numIndices;
+  BakedPtr<vec3> position;
+  BakedPtr<vec3> normal;
+  BakedPtr<vec2> texCoord;
+  BakedPtr<vec4> weights;
+  BakedPtr<ivec4> influences;
+  BakedPtr<uint32_t> indices;
+};
+
+struct BakedHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t fileSize;
+  uint32_t numClips;
+  uint32_t numMeshes;
+  BakedPtr<BakedSkeleton> skeleton;
+  BakedPtr<BakedClip> clips;
+  BakedPtr<BakedMesh> meshes;
+};
+
+// offline: write a baked file, returns false on io errors
+bool SaveBakedFile(const char* path, Skeleton& skeleton, std::vector<Clip>& clips, std::vector<Mesh>& meshes);
+
+// runtime: map a baked file and fix up its offsets in place
+// returns 0 when the file is missing, corrupt or from another version
+// the header and everything it points to stay valid until FreeBakedFile
+BakedHeader* LoadBakedFile(const char* path);
+void FreeBakedFile(BakedHeader* file);
+
+// runtime objects from a loaded file, each array is one bulk copy
+// out of the mapping
+Skeleton LoadSkeleton(BakedHeader* file);
+std::vector<Clip> LoadAnimationClips(BakedHeader* file);
+Clip LoadAnimationClip(BakedHeader* file, unsigned int index);
+// with keepCPUData false the vertex streams are uploaded straight
+// from the mapping, nothing is copied on the CPU
+std::vector<Mesh> LoadMeshes(BakedHeader* file, bool keepCPUData = true);
@@ -0,0 +1,164 @@
+#include "Clip.h"
+#include <cmath>
+
+Clip::Clip()
+{
+  m_Name = "No name given";
+  m_StartTime = 0.0f;
+  m_EndTime = 0.0f;
+  m_Looping = true;
+}
+
+unsigned int Clip::Size()
+{
+  return (unsigned int) m_Tracks.size();
+}
+
+void Clip::Reserve(unsigned int numTracks)
+{
+  m_Tracks.reserve(numTracks);
+}
+
+unsigned int Clip::GetIdAtIndex(unsigned int index)
+{
+  return m_Tracks[index].GetId();
+}
+
+void Clip::SetIdAtIndex(unsigned int index, unsigned int id)
+{
+  m_Tracks[index].SetId(id);
+}
+
+TransformTrack& Clip::operator[](unsigned int joint)
+{
+  for (unsigned int i = 0, size = (unsigned int) m_Tracks.size(); i < size; ++i)
+  {
+    if (m_Tracks[i].GetId() == joint)
+    {
+      return m_Tracks[i];
+    }
+  }
+  m_Tracks.push_back(TransformTrack());
+  m_Tracks.back().SetId(joint);
+  return m_Tracks.back();
+}
+
+float Clip::AdjustTimeToFitRange(float time)
+{
+  float duration = m_EndTime - m_StartTime;
+  if (duration <= 0.0f)
+  {
+    return 0.0f;
+  }
+  if (m_Looping)
+  {
+    time = fmodf(time - m_StartTime, duration);
+    if (time < 0.0f)
+    {
+      time += duration;
+    }
+    time = time + m_StartTime;
+  }
+  else
+  {
+    if (time < m_StartTime)
+    {
+      time = m_StartTime;
+    }
+    if (time > m_EndTime)
+    {
+      time = m_EndTime;
+    }
+  }
+  return time;
+}
+
+float Clip::Sample(Pose& outPose, float time)
+{
+  if (GetDuration() == 0.0f)
+  {
+    return 0.0f;
+  }
+  time = AdjustTimeToFitRange(time);
+  for (unsigned int i = 0, size = (unsigned int) m_Tracks.size(); i < size; ++i)
+  {
+    unsigned int joint = m_Tracks[i].GetId();
+    Transform local = outPose.GetLocalTransform(joint);
+    Transform animated = m_Tracks[i].Sample(local, time, m_Looping);
+    outPose.SetLocalTransform(joint, animated);
+  }
+  return time;
+}
+
+void Clip::RecalculateDuration()
+{
+  m_StartTime = 0.0f;
+  m_EndTime = 0.0f;
+  bool startSet = false;
+  bool endSet = false;
+  for (unsigned int i = 0, size = (unsigned int) m_Tracks.size(); i < size; ++i)
+  {
+    if (!m_Tracks[i].IsValid())
+    {
+      continue;
+    }
+    float start = m_Tracks[i].GetStartTime();
+    float end = m_Tracks[i].GetEndTime();
+    if (start < m_StartTime || !startSet)
+    {
+      m_StartTime = start;
+      startSet = true;
+    }
+    if (end > m_EndTime || !endSet)
+    {
+      m_EndTime = end;
+      endSet = true;
+    }
+  }
+}
+
+std::string& Clip::GetName()
+{
+  return m_Name;
+}
+
+void Clip::SetName(const std::string& name)
+{
+  m_Name = name;
+}
+
+float Clip::GetDuration()
+{
+  return m_EndTime - m_StartTime;
+}
+
+float Clip::GetStartTime()
+{
+  return m_StartTime;
+}
+
+float Clip::GetEndTime()
+{
+  return m_EndTime;
+}
+
+bool Clip::GetLooping()
+{
+  return m_Looping;
+}
+
+void Clip::SetLooping(bool looping)
+{
+  m_Looping = looping;
+}
+
+NameTable MakeClipTable(std::vector<Clip>& clips)
+{
+  NameTable result;
+  result.Reserve((unsigned int) clips.size());
+  for (unsigned int i = 0, size = (unsigned int) clips.size(); i < size; ++i)
+  {
+    result.Add(clips[i].GetName());
+  }
+  return result;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "TransformTrack.h"
+#include "Pose.h"
+#include "NameTable.h"
+#include <vector>
+#include <string>
+
+class Clip {
+  // an animation clip is a set of transform tracks, one per
+  // animated joint, sampled together into a pose
+protected:
+  std::vector<TransformTrack> m_Tracks;
+  std::string m_Name;
+  float m_StartTime;
+  float m_EndTime;
+  bool m_Looping;
+
+protected:
+  float AdjustTimeToFitRange(float time);
+
+public:
+  Clip();
+  unsigned int Size();
+  void Reserve(unsigned int numTracks);
+  unsigned int GetIdAtIndex(unsigned int index);
+  void SetIdAtIndex(unsigned int index, unsigned int id);
+  // track for a joint, created if the clip doesn't animate it yet
+  TransformTrack& operator[](unsigned int joint);
+  // samples every track into outPose, returns the adjusted time
+  float Sample(Pose& outPose, float time);
+  void RecalculateDuration();
+
+  std::string& GetName();
+  void SetName(const std::string& name);
+  float GetDuration();
+  float GetStartTime();
+  float GetEndTime();
+  bool GetLooping();
+  void SetLooping(bool looping);
+};
+
+// clip names of a set of clips, index i is clips[i]
+NameTable MakeClipTable(std::vector<Clip>& clips);
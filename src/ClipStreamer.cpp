@@ -0,0 +1,466 @@
+#include "ClipStreamer.h"
+#include "GLTFLoader.h"
+#include "BakedAsset.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// **********************//
+//                       //
+//        Metadata       //
+//                       //
+// **********************//
+
+static bool IsBakedFile(const std::string& path)
+{
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == 0)
+  {
+    return false;
+  }
+  uint32_t magic = 0;
+  size_t read = fread(&magic, sizeof(uint32_t), 1, file);
+  fclose(file);
+  return read == 1 && magic == BAKED_MAGIC;
+}
+
+static std::string DefaultClipName(const std::string& path, unsigned int index)
+{
+  return path + ":" + std::to_string(index);
+}
+
+static void ExtendRange(StreamedClipInfo& info, bool& isSet, float start, float end)
+{
+  if (start < info.startTime || !isSet)
+  {
+    info.startTime = start;
+  }
+  if (end > info.endTime || !isSet)
+  {
+    info.endTime = end;
+  }
+  isSet = true;
+}
+
+// times come from the sampler input min/max (required by the spec),
+// or the first and last key if a file leaves them out. no keyframe
+// data is unpacked
+static StreamedClipInfo InfoFromAnimation(const cgltf_animation& animation)
+{
+  StreamedClipInfo info;
+  info.index = 0;
+  info.baked = false;
+  info.startTime = 0.0f;
+  info.endTime = 0.0f;
+  info.looping = true;
+  info.bytes = sizeof(Clip);
+  if (animation.name != 0)
+  {
+    info.name = animation.name;
+  }
+  bool isSet = false;
+  for (unsigned int i = 0; i < animation.channels_count; ++i)
+  {
+    cgltf_animation_channel& channel = animation.channels[i];
+    if (channel.target_node == 0 || channel.sampler == 0)
+    {
+      continue;
+    }
+    size_t frameSize = 0;
+    if (channel.target_path == cgltf_animation_path_type_translation
+      || channel.target_path == cgltf_animation_path_type_scale)
+    {
+      frameSize = sizeof(Frame<3>);
+    }
+    else if (channel.target_path == cgltf_animation_path_type_rotation)
+    {
+      frameSize = sizeof(Frame<4>);
+    }
+    else
+    {
+      continue;
+    }
+    cgltf_accessor* input = channel.sampler->input;
+    // worst case, one transform track per channel
+    info.bytes += sizeof(TransformTrack) + input->count * frameSize;
+    if (input->count < 2)
+    {
+      continue;
+    }
+    float start = 0.0f;
+    float end = 0.0f;
+    if (input->has_min && input->has_max)
+    {
+      start = input->min[0];
+      end = input->max[0];
+    }
+    else
+    {
+      cgltf_accessor_read_float(input, 0, &start, 1);
+      cgltf_accessor_read_float(input, input->count - 1, &end, 1);
+    }
+    ExtendRange(info, isSet, start, end);
+  }
+  return info;
+}
+
+static StreamedClipInfo InfoFromBaked(const BakedClip& clip)
+{
+  StreamedClipInfo info;
+  info.index = 0;
+  info.baked = true;
+  info.startTime = 0.0f;
+  info.endTime = 0.0f;
+  info.looping = clip.looping != 0;
+  info.bytes = sizeof(Clip) + strlen(clip.name.ptr);
+  info.name = clip.name.ptr;
+  bool isSet = false;
+  for (unsigned int i = 0; i < clip.numTracks; ++i)
+  {
+    const BakedTrack& track = clip.tracks.ptr[i];
+    // m_Time is the last float of a frame
+    unsigned int stride = track.component == BakedRotation ? 13 : 10;
+    info.bytes += sizeof(TransformTrack) + track.numFrames * stride * sizeof(float);
+    if (track.numFrames < 2)
+    {
+      continue;
+    }
+    const float* frames = track.frames.ptr;
+    ExtendRange(info, isSet, frames[stride - 1], frames[track.numFrames * stride - 1]);
+  }
+  return info;
+}
+
+template<typename T, int N>
+static size_t TrackBytes(Track<T, N>& track)
+{
+  return track.Size() * sizeof(Frame<N>);
+}
+
+static size_t ClipBytes(Clip& clip)
+{
+  size_t bytes = sizeof(Clip) + clip.GetName().size();
+  for (unsigned int i = 0, size = clip.Size(); i < size; ++i)
+  {
+    TransformTrack& track = clip[clip.GetIdAtIndex(i)];
+    bytes += sizeof(TransformTrack) + TrackBytes(track.GetPositionTrack())
+      + TrackBytes(track.GetRotationTrack()) + TrackBytes(track.GetScaleTrack());
+  }
+  return bytes;
+}
+
+// **********************//
+//                       //
+//        Streamer       //
+//                       //
+// **********************//
+
+ClipStreamer::ClipStreamer(size_t budgetBytes)
+{
+  m_Budget = budgetBytes;
+  m_Resident = 0;
+  m_Clock = 0;
+  m_NumLoads = 0;
+  m_NumEvictions = 0;
+  m_Stopping = false;
+  m_Prefetcher = std::thread(&ClipStreamer::PrefetchLoop, this);
+}
+
+// a prefetch in flight finishes first, the rest of the queue is dropped
+ClipStreamer::~ClipStreamer()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_Stopping = true;
+    m_Prefetch.clear();
+  }
+  m_PrefetchSignal.notify_all();
+  m_Prefetcher.join();
+}
+
+unsigned int ClipStreamer::RegisterFile(const std::string& path)
+{
+  std::vector<StreamedClipInfo> infos;
+  if (IsBakedFile(path))
+  {
+    BakedHeader* file = LoadBakedFile(path.c_str());
+    if (file == 0)
+    {
+      return 0;
+    }
+    for (unsigned int i = 0; i < file->numClips; ++i)
+    {
+      infos.push_back(InfoFromBaked(file->clips.ptr[i]));
+    }
+    FreeBakedFile(file);
+  }
+  else
+  {
+    cgltf_data* data = LoadGLTFFile(path.c_str(), true);
+    if (data == 0)
+    {
+      return 0;
+    }
+    for (unsigned int i = 0; i < data->animations_count; ++i)
+    {
+      infos.push_back(InfoFromAnimation(data->animations[i]));
+    }
+    FreeGLTTFile(data);
+  }
+
+  std::unique_lock<std::mutex> lock(m_Lock);
+  for (unsigned int i = 0; i < infos.size(); ++i)
+  {
+    StreamedClipInfo& info = infos[i];
+    info.path = path;
+    info.index = i;
+    if (info.name.empty())
+    {
+      info.name = DefaultClipName(path, i);
+    }
+
+    int found = m_Names.Find(info.name);
+    if (found < 0)
+    {
+      Entry entry;
+      entry.info = info;
+      entry.lastUsed = 0;
+      entry.loading = false;
+      m_Names.Add(info.name);
+      m_Entries.push_back(entry);
+      continue;
+    }
+    // replaced, handles already out keep the old clip alive
+    unsigned int index = (unsigned int) found;
+    m_Loaded.wait(lock, [this, index]() { return !m_Entries[index].loading; });
+    Entry& entry = m_Entries[index];
+    if (entry.clip)
+    {
+      m_Resident -= entry.info.bytes;
+      entry.clip.reset();
+    }
+    entry.info = info;
+  }
+  return (unsigned int) infos.size();
+}
+
+bool ClipStreamer::IsRegistered(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_Names.Find(name) >= 0;
+}
+
+const StreamedClipInfo* ClipStreamer::GetInfo(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  int index = m_Names.Find(name);
+  if (index < 0)
+  {
+    return 0;
+  }
+  return &m_Entries[index].info;
+}
+
+unsigned int ClipStreamer::Size()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return (unsigned int) m_Entries.size();
+}
+
+ClipHandle ClipStreamer::Load(std::unique_lock<std::mutex>& lock, unsigned int entry)
+{
+  // someone else is loading it already, use theirs
+  m_Loaded.wait(lock, [this, entry]() { return !m_Entries[entry].loading; });
+  if (m_Entries[entry].clip)
+  {
+    m_Entries[entry].lastUsed = ++m_Clock;
+    return m_Entries[entry].clip;
+  }
+
+  m_Entries[entry].loading = true;
+  StreamedClipInfo info = m_Entries[entry].info;
+  lock.unlock();
+
+  ClipHandle clip;
+  if (info.baked)
+  {
+    BakedHeader* file = LoadBakedFile(info.path.c_str());
+    if (file != 0)
+    {
+      clip = std::make_shared<Clip>(LoadAnimationClip(file, info.index));
+      FreeBakedFile(file);
+    }
+  }
+  else
+  {
+    cgltf_data* data = LoadGLTFFile(info.path.c_str(), true);
+    if (data != 0)
+    {
+      clip = std::make_shared<Clip>(LoadAnimationClip(data, info.index));
+      FreeGLTTFile(data);
+    }
+  }
+  size_t bytes = clip ? ClipBytes(*clip) : 0;
+
+  lock.lock();
+  // entries are never removed, the index is still good even if the
+  // vector grew in the meantime
+  Entry& result = m_Entries[entry];
+  result.loading = false;
+  if (clip)
+  {
+    result.clip = clip;
+    result.info.bytes = bytes;
+    result.lastUsed = ++m_Clock;
+    m_Resident += bytes;
+    ++m_NumLoads;
+    // clip is held here, so it can't be the one evicted
+    Trim();
+  }
+  else
+  {
+    std::cout<<"Could not stream clip: "<<info.name<<"\n";
+  }
+  m_Loaded.notify_all();
+  return clip;
+}
+
+// only the streamer holding a clip (use_count 1) means nobody plays it
+// handles are only copied under the lock, so that can't change under us
+// released handles don't trim by themselves, so this also runs at the
+// start of Acquire, TryAcquire and Prefetch to get back under budget
+void ClipStreamer::Trim()
+{
+  while (m_Resident > m_Budget)
+  {
+    Entry* oldest = 0;
+    for (unsigned int i = 0, size = (unsigned int) m_Entries.size(); i < size; ++i)
+    {
+      Entry& entry = m_Entries[i];
+      if (entry.clip && entry.clip.use_count() == 1 && (oldest == 0 || entry.lastUsed < oldest->lastUsed))
+      {
+        oldest = &entry;
+      }
+    }
+    if (oldest == 0)
+    {
+      return;
+    }
+    m_Resident -= oldest->info.bytes;
+    oldest->clip.reset();
+    ++m_NumEvictions;
+  }
+}
+
+ClipHandle ClipStreamer::Acquire(const std::string& name)
+{
+  std::unique_lock<std::mutex> lock(m_Lock);
+  // handles released since the last call may have freed up room
+  Trim();
+  int index = m_Names.Find(name);
+  if (index < 0)
+  {
+    return ClipHandle();
+  }
+  return Load(lock, (unsigned int) index);
+}
+
+ClipHandle ClipStreamer::TryAcquire(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  int index = m_Names.Find(name);
+  if (index < 0 || !m_Entries[index].clip)
+  {
+    return ClipHandle();
+  }
+  Entry& entry = m_Entries[index];
+  entry.lastUsed = ++m_Clock;
+  // held before trimming so it can't be the one evicted
+  ClipHandle clip = entry.clip;
+  Trim();
+  return clip;
+}
+
+void ClipStreamer::Prefetch(const std::string& name)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Lock);
+    Trim();
+    int found = m_Names.Find(name);
+    if (found < 0)
+    {
+      return;
+    }
+    unsigned int index = (unsigned int) found;
+    Entry& entry = m_Entries[index];
+    if (entry.clip)
+    {
+      // already here, keep it from being evicted before it plays
+      entry.lastUsed = ++m_Clock;
+      return;
+    }
+    if (entry.loading || std::find(m_Prefetch.begin(), m_Prefetch.end(), index) != m_Prefetch.end())
+    {
+      return;
+    }
+    m_Prefetch.push_back(index);
+  }
+  m_PrefetchSignal.notify_one();
+}
+
+void ClipStreamer::PrefetchLoop()
+{
+  std::unique_lock<std::mutex> lock(m_Lock);
+  for (;;)
+  {
+    m_PrefetchSignal.wait(lock, [this]() { return m_Stopping || !m_Prefetch.empty(); });
+    if (m_Stopping)
+    {
+      return;
+    }
+    unsigned int index = m_Prefetch.front();
+    m_Prefetch.pop_front();
+    // handle dropped right away, the clip stays resident as the most
+    // recently used one
+    Load(lock, index);
+  }
+}
+
+bool ClipStreamer::IsResident(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  int index = m_Names.Find(name);
+  return index >= 0 && m_Entries[index].clip;
+}
+
+void ClipStreamer::SetBudget(size_t budgetBytes)
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  m_Budget = budgetBytes;
+  Trim();
+}
+
+size_t ClipStreamer::GetBudget()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_Budget;
+}
+
+size_t ClipStreamer::GetResidentBytes()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_Resident;
+}
+
+unsigned int ClipStreamer::GetNumLoads()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_NumLoads;
+}
+
+unsigned int ClipStreamer::GetNumEvictions()
+{
+  std::lock_guard<std::mutex> lock(m_Lock);
+  return m_NumEvictions;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "AssetCache.h"
+#include "NameTable.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// what is known about a clip without loading it
+struct StreamedClipInfo
+{
+  std::string name;
+  std::string path;
+  unsigned int index; // animation index inside the file
+  bool baked;
+  float startTime;
+  float endTime;
+  bool looping;
+  // estimate until the clip is loaded once, exact after that
+  size_t bytes;
+};
+
+class ClipStreamer {
+  // clips are registered by name with only their metadata resident,
+  // loaded on first Acquire (glTF or baked file) and evicted least
+  // recently used first once the resident bytes go over budget
+  // clips with handles still held outside the streamer are never
+  // evicted, so the budget can be exceeded while they play, it's
+  // enforced again by the next Acquire, TryAcquire or Prefetch
+  // Prefetch loads on a background thread ahead of a transition
+protected:
+  struct Entry
+  {
+    StreamedClipInfo info;
+    ClipHandle clip;
+    uint64_t lastUsed;
+    bool loading;
+  };
+
+  std::vector<Entry> m_Entries;
+  NameTable m_Names; // index into m_Entries
+  size_t m_Budget;
+  size_t m_Resident;
+  uint64_t m_Clock;
+  unsigned int m_NumLoads;
+  unsigned int m_NumEvictions;
+  std::mutex m_Lock;
+  std::condition_variable m_Loaded;
+
+  std::thread m_Prefetcher;
+  std::deque<unsigned int> m_Prefetch;
+  std::condition_variable m_PrefetchSignal;
+  bool m_Stopping;
+
+protected:
+  void PrefetchLoop();
+  // lock must be held, it's released while the file is read
+  ClipHandle Load(std::unique_lock<std::mutex>& lock, unsigned int entry);
+  // lock must be held
+  void Trim();
+
+public:
+  ClipStreamer(size_t budgetBytes);
+  ~ClipStreamer();
+
+  // registers every clip in a glTF, GLB or baked file, only the
+  // metadata is read. returns the number of clips, 0 on errors
+  // a name that's already registered is replaced
+  unsigned int RegisterFile(const std::string& path);
+  bool IsRegistered(const std::string& name);
+  // 0 if the name isn't registered, only valid until the next
+  // RegisterFile
+  const StreamedClipInfo* GetInfo(const std::string& name);
+  unsigned int Size();
+
+  // resident clip, loaded right away if needed (blocks). null if
+  // the name isn't registered or the load failed
+  ClipHandle Acquire(const std::string& name);
+  // never blocks, null unless the clip is resident
+  ClipHandle TryAcquire(const std::string& name);
+  // hint that a clip is about to play, queued for the prefetch thread
+  void Prefetch(const std::string& name);
+  bool IsResident(const std::string& name);
+
+  void SetBudget(size_t budgetBytes);
+  size_t GetBudget();
+  size_t GetResidentBytes();
+  unsigned int GetNumLoads();
+  unsigned int GetNumEvictions();
+
+private:
+  ClipStreamer(const ClipStreamer& other);
+  ClipStreamer& operator=(const ClipStreamer& other);
+};
@@ -1,18 +1,218 @@
 #include "GLTFLoader.h"
+#include "MeshOptimizer.h"
+#include <chrono>
+#include <cmath>
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
-cgltf_data* LoadGLTFFile(const char* path)
+#if defined(__unix__) || defined(__APPLE__)
+#define GLTF_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef GLTF_MMAP
+// cgltf only hands the pointer back on release, so remember the
+// size of every mapping. guarded, files may be loaded from
+// several threads
+static std::mutex s_MappingsLock;
+static std::unordered_map<void*, size_t> s_Mappings;
+
+// cgltf file read callback: maps the file instead of reading it.
+// used for the .glb itself and any external .bin buffers
+static cgltf_result MapFile(const struct cgltf_memory_options*,
+  const struct cgltf_file_options*, const char* path, cgltf_size* size, void** data)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return cgltf_result_file_not_found;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0)
+  {
+    close(fd);
+    return cgltf_result_io_error;
+  }
+  size_t length = (size_t) info.st_size;
+  if (size != 0 && *size != 0)
+  {
+    if (*size > length)
+    {
+      close(fd);
+      return cgltf_result_data_too_short;
+    }
+    length = *size;
+  }
+  // private + writable is copy on write, pages are only copied if
+  // something writes to them
+  void* mapping = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    return cgltf_result_io_error;
+  }
+  {
+    std::lock_guard<std::mutex> lock(s_MappingsLock);
+    s_Mappings[mapping] = length;
+  }
+  if (size != 0)
+  {
+    *size = length;
+  }
+  *data = mapping;
+  return cgltf_result_success;
+}
+
+// cgltf file release callback. base64 buffers are released through
+// here as well, anything that isn't a mapping came from malloc
+static void UnmapFile(const struct cgltf_memory_options*,
+  const struct cgltf_file_options*, void* data)
+{
+  if (data == 0)
+  {
+    return;
+  }
+  size_t length = 0;
+  {
+    std::lock_guard<std::mutex> lock(s_MappingsLock);
+    std::unordered_map<void*, size_t>::iterator it = s_Mappings.find(data);
+    if (it != s_Mappings.end())
+    {
+      length = it->second;
+      s_Mappings.erase(it);
+    }
+  }
+  if (length > 0)
+  {
+    munmap(data, length);
+  }
+  else
+  {
+    free(data);
+  }
+}
+#endif
+
+// required extensions the importer understands, anything else is
+// loaded anyway but may come out wrong
+static void WarnRequiredExtensions(cgltf_data* data, const char* path)
+{
+  for (unsigned int i = 0; i < data->extensions_required_count; ++i)
+  {
+    const char* extension = data->extensions_required[i];
+    if (strcmp(extension, "KHR_mesh_quantization") != 0)
+    {
+      std::cout<<"WARNING: "<<path<<" requires unsupported extension "<<extension<<"\n";
+    }
+  }
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point& since)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(now - since).count();
+  since = now;
+  return ms;
+}
+
+// 64 bit FNV-1a, 8 bytes at a time, the tail is zero padded
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+  const unsigned char* bytes = (const unsigned char*) data;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    memcpy(&word, bytes + i, 8);
+    hash = (hash ^ word) * 0x100000001B3ull;
+  }
+  if (i < size)
+  {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, size - i);
+    hash = (hash ^ word) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+uint64_t GetGLTFChecksum(cgltf_data* data)
+{
+  uint64_t hash = HashBytes(0xCBF29CE484222325ull, data->json, data->json_size);
+  uint64_t sizes[2] = { data->bin_size, data->buffers_count };
+  hash = HashBytes(hash, sizes, sizeof(sizes));
+  for (unsigned int i = 0; i < data->buffers_count; ++i)
+  {
+    uint64_t size = data->buffers[i].size;
+    hash = HashBytes(hash, &size, sizeof(size));
+  }
+  return hash;
+}
+
+// memoryMapped maps the file instead of reading it into the heap.
+// for a .glb, cgltf points buffer 0 at the binary chunk, so with
+// the file mapped every accessor is read in place from the mapping
+// and no vertex or animation data is copied at load time
+// (falls back to a normal load where mmap isn't available)
+// checksum is 0 for a normal load, otherwise validation is skipped
+// if it matches GetGLTFChecksum
+static cgltf_data* LoadFile(const char* path, bool memoryMapped, uint64_t checksum, GLTFLoadReport* report)
 {
+  GLTFLoadReport local;
+  if (report == 0)
+  {
+    report = &local;
+  }
+  memset(report, 0, sizeof(GLTFLoadReport));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point phase = start;
+
   cgltf_options options;
   memset(&options, 0, sizeof(cgltf_options));
   cgltf_data* data = NULL;
-  cgltf_result result = cgltf_parse_file(&options, path, &data);
+  cgltf_result result;
+#ifdef GLTF_MMAP
+  if (memoryMapped)
+  {
+    options.file.read = &MapFile;
+    options.file.release = &UnmapFile;
+    // not cgltf_parse_file, it frees the file with the memory
+    // callbacks when parsing fails instead of the release callback
+    void* mapping = 0;
+    cgltf_size size = 0;
+    result = MapFile(&options.memory, &options.file, path, &size, &mapping);
+    if (result == cgltf_result_success)
+    {
+      result = cgltf_parse(&options, mapping, size, &data);
+      if (result != cgltf_result_success)
+      {
+        UnmapFile(&options.memory, &options.file, mapping);
+      }
+      else
+      {
+        // released by cgltf_free through UnmapFile
+        data->file_data = mapping;
+      }
+    }
+  }
+  else
+#endif
+  {
+    result = cgltf_parse_file(&options, path, &data);
+  }
   if(result != cgltf_result_success)
   {
       std::cout<<"Could not load:"<<path<<"\n";
       return 0;
   }
+  report->parseMs = ElapsedMs(phase);
+  report->jsonBytes = data->json_size;
+
   result = cgltf_load_buffers(&options, data, path);
   if(result != cgltf_result_success)
   {
@@ -20,16 +220,71 @@ cgltf_data* LoadGLTFFile(const char* path)
     std::cout<<"Could not load:"<<path<<"\n";
     return 0;
   }
-  result = cgltf_validate(data);
-  if (result != cgltf_result_success)
+  report->buffersMs = ElapsedMs(phase);
+  report->numBuffers = (unsigned int) data->buffers_count;
+  for (unsigned int i = 0; i < data->buffers_count; ++i)
   {
-    cgltf_free(data);
-    std::cout<<"Invalid file:"<<path<<"\n";
-    return 0;
+    report->bufferBytes += data->buffers[i].size;
   }
+
+  bool trusted = false;
+  if (checksum != 0)
+  {
+    report->checksum = GetGLTFChecksum(data);
+    trusted = report->checksum == checksum;
+    if (!trusted)
+    {
+      std::cout<<"WARNING: "<<path<<" checksum mismatch, validating\n";
+    }
+    report->checksumMs = ElapsedMs(phase);
+  }
+  if (!trusted)
+  {
+    result = cgltf_validate(data);
+    if (result != cgltf_result_success)
+    {
+      cgltf_free(data);
+      std::cout<<"Invalid file:"<<path<<"\n";
+      return 0;
+    }
+    report->validated = true;
+    report->validateMs = ElapsedMs(phase);
+  }
+  WarnRequiredExtensions(data, path);
+  report->totalMs = ElapsedMs(start);
   return data;
 }
 
+cgltf_data* LoadGLTFFile(const char* path, bool memoryMapped, GLTFLoadReport* report)
+{
+  return LoadFile(path, memoryMapped, 0, report);
+}
+
+cgltf_data* LoadTrustedGLTFFile(const char* path, uint64_t checksum, bool memoryMapped, GLTFLoadReport* report)
+{
+  return LoadFile(path, memoryMapped, checksum, report);
+}
+
+void PrintLoadReport(const char* path, const GLTFLoadReport& report)
+{
+  std::cout<<path<<": "<<report.totalMs<<" ms total, parse "<<report.parseMs
+    <<" ms ("<<report.jsonBytes<<" bytes json), buffers "<<report.buffersMs
+    <<" ms ("<<report.numBuffers<<" buffers, "<<report.bufferBytes<<" bytes)";
+  if (report.checksum != 0)
+  {
+    std::cout<<", checksum "<<report.checksumMs<<" ms";
+  }
+  if (report.validated)
+  {
+    std::cout<<", validate "<<report.validateMs<<" ms";
+  }
+  else
+  {
+    std::cout<<", validation skipped";
+  }
+  std::cout<<"\n";
+}
+
 void FreeGLTTFile(cgltf_data* data)
 {
   if(data == 0)
@@ -41,3 +296,794 @@ void FreeGLTTFile(cgltf_data* data)
     cgltf_free(data);
   }
 }
+
+// first byte of a dense accessor's data, 0 when the accessor is
+// sparse or has no loaded buffer and has to go through cgltf
+static const unsigned char* AccessorData(const cgltf_accessor* accessor)
+{
+  if (accessor->is_sparse || accessor->buffer_view == 0 || accessor->buffer_view->buffer->data == 0)
+  {
+    return 0;
+  }
+  return (const unsigned char*) accessor->buffer_view->buffer->data
+    + accessor->buffer_view->offset + accessor->offset;
+}
+
+// KHR_mesh_quantization stores positions, normals and texcoords as
+// 8 or 16 bit ints, normalized or not. cgltf reads unnormalized ints
+// through an unsigned size_t, which breaks negative values, so dense
+// int data is converted here. normalized signed values clamp at -1
+// like the GL fetch does
+static float ComponentToFloat(const unsigned char* src, cgltf_component_type type, bool normalized)
+{
+  switch (type)
+  {
+    case cgltf_component_type_r_8:
+    {
+      float f = (float) *(const signed char*) src;
+      return normalized ? fmaxf(f / 127.0f, -1.0f) : f;
+    }
+    case cgltf_component_type_r_8u:
+    {
+      float f = (float) *src;
+      return normalized ? f / 255.0f : f;
+    }
+    case cgltf_component_type_r_16:
+    {
+      short value;
+      memcpy(&value, src, sizeof(short));
+      float f = (float) value;
+      return normalized ? fmaxf(f / 32767.0f, -1.0f) : f;
+    }
+    case cgltf_component_type_r_16u:
+    {
+      unsigned short value;
+      memcpy(&value, src, sizeof(unsigned short));
+      float f = (float) value;
+      return normalized ? f / 65535.0f : f;
+    }
+    case cgltf_component_type_r_32u:
+    {
+      unsigned int value;
+      memcpy(&value, src, sizeof(unsigned int));
+      return (float) value;
+    }
+    case cgltf_component_type_r_32f:
+    {
+      float value;
+      memcpy(&value, src, sizeof(float));
+      return value;
+    }
+    default:
+      return 0.0f;
+  }
+}
+
+static unsigned int ComponentSize(cgltf_component_type type)
+{
+  switch (type)
+  {
+    case cgltf_component_type_r_8:
+    case cgltf_component_type_r_8u:
+      return 1;
+    case cgltf_component_type_r_16:
+    case cgltf_component_type_r_16u:
+      return 2;
+    default:
+      return 4;
+  }
+}
+
+// unpacks a whole accessor into out (count * numComponents floats)
+// dense float data is copied straight from the buffer, one memcpy
+// when tightly packed. dense ints are converted element by element,
+// sparse accessors go through cgltf
+static void UnpackFloats(const cgltf_accessor* accessor, float* out, unsigned int numComponents)
+{
+  unsigned int count = (unsigned int) accessor->count;
+  const unsigned char* src = AccessorData(accessor);
+  if (src == 0)
+  {
+    cgltf_accessor_unpack_floats(accessor, out, count * numComponents);
+    return;
+  }
+  if (accessor->component_type != cgltf_component_type_r_32f)
+  {
+    unsigned int componentSize = ComponentSize(accessor->component_type);
+    bool normalized = accessor->normalized != 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      const unsigned char* element = src + i * accessor->stride;
+      for (unsigned int c = 0; c < numComponents; ++c)
+      {
+        out[i * numComponents + c] = ComponentToFloat(element + c * componentSize, accessor->component_type, normalized);
+      }
+    }
+    return;
+  }
+  unsigned int elementSize = numComponents * sizeof(float);
+  if (accessor->stride == elementSize)
+  {
+    memcpy(out, src, count * elementSize);
+    return;
+  }
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    memcpy(out + i * numComponents, src + i * accessor->stride, elementSize);
+  }
+}
+
+// integer components read straight from the buffer, out gets
+// count * numComponents values
+static void UnpackUints(const cgltf_accessor* accessor, unsigned int* out, unsigned int numComponents)
+{
+  unsigned int count = (unsigned int) accessor->count;
+  const unsigned char* src = AccessorData(accessor);
+  if (src == 0)
+  {
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      cgltf_accessor_read_uint(accessor, i, out + i * numComponents, numComponents);
+    }
+    return;
+  }
+  unsigned int stride = (unsigned int) accessor->stride;
+  switch (accessor->component_type)
+  {
+    case cgltf_component_type_r_8u:
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const unsigned char* e = src + i * stride;
+        for (unsigned int c = 0; c < numComponents; ++c)
+        {
+          out[i * numComponents + c] = e[c];
+        }
+      }
+      break;
+    case cgltf_component_type_r_16u:
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        const unsigned short* e = (const unsigned short*) (src + i * stride);
+        for (unsigned int c = 0; c < numComponents; ++c)
+        {
+          out[i * numComponents + c] = e[c];
+        }
+      }
+      break;
+    case cgltf_component_type_r_32u:
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        memcpy(out + i * numComponents, src + i * stride, numComponents * sizeof(unsigned int));
+      }
+      break;
+    default:
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        cgltf_accessor_read_uint(accessor, i, out + i * numComponents, numComponents);
+      }
+      break;
+  }
+}
+
+// local transform of a node, either a matrix or separate
+// translation/rotation/scale (missing parts stay identity)
+static Transform GetLocalTransform(const cgltf_node& node)
+{
+  Transform result;
+  if (node.has_matrix)
+  {
+    mat4 mat((float*) &node.matrix[0]);
+    result = mat4ToTransform(mat);
+  }
+  if (node.has_translation)
+  {
+    result.position = vec3(node.translation[0], node.translation[1], node.translation[2]);
+  }
+  if (node.has_rotation)
+  {
+    result.rotation = quat(node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
+  }
+  if (node.has_scale)
+  {
+    result.scale = vec3(node.scale[0], node.scale[1], node.scale[2]);
+  }
+  return result;
+}
+
+// roots first in file order, then a queue walk that appends the
+// children of each joint, no recursion needed
+std::vector<int> GetJointOrder(cgltf_data* data)
+{
+  unsigned int numNodes = (unsigned int) data->nodes_count;
+  std::vector<int> order;
+  order.reserve(numNodes);
+  for (unsigned int i = 0; i < numNodes; ++i)
+  {
+    if (data->nodes[i].parent == 0)
+    {
+      order.push_back((int) i);
+    }
+  }
+  for (unsigned int i = 0; i < order.size(); ++i)
+  {
+    cgltf_node& node = data->nodes[order[i]];
+    for (unsigned int c = 0; c < node.children_count; ++c)
+    {
+      order.push_back((int) (node.children[c] - data->nodes));
+    }
+  }
+  return order;
+}
+
+std::vector<int> GetNodeJoints(cgltf_data* data)
+{
+  std::vector<int> order = GetJointOrder(data);
+  std::vector<int> nodeJoints(data->nodes_count, -1);
+  for (unsigned int i = 0, size = (unsigned int) order.size(); i < size; ++i)
+  {
+    nodeJoints[order[i]] = (int) i;
+  }
+  return nodeJoints;
+}
+
+NameTable LoadNodeTable(cgltf_data* data)
+{
+  NameTable result;
+  result.Reserve((unsigned int) data->nodes_count);
+  for (unsigned int i = 0; i < data->nodes_count; ++i)
+  {
+    const char* name = data->nodes[i].name;
+    result.Add(name != 0 ? name : "", name != 0 ? strlen(name) : 0);
+  }
+  return result;
+}
+
+Pose LoadRestPose(cgltf_data* data)
+{
+  std::vector<int> order = GetJointOrder(data);
+  std::vector<int> nodeJoints = GetNodeJoints(data);
+  unsigned int numJoints = (unsigned int) order.size();
+  Pose result(numJoints);
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    cgltf_node& node = data->nodes[order[i]];
+    result.SetLocalTransform(i, GetLocalTransform(node));
+    int parent = node.parent == 0 ? -1 : nodeJoints[node.parent - data->nodes];
+    result.SetParent(i, parent);
+  }
+  return result;
+}
+
+// the bind pose comes from the inverse bind matrices of the skins,
+// joints no skin references keep their rest transform
+Pose LoadBindPose(cgltf_data* data)
+{
+  Pose restPose = LoadRestPose(data);
+  std::vector<int> nodeJoints = GetNodeJoints(data);
+  unsigned int numJoints = restPose.Size();
+
+  // world space rest transforms, parents first so one pass
+  std::vector<Transform> worldBindPose(numJoints);
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    Transform local = restPose.GetLocalTransform(i);
+    int parent = restPose.GetParent(i);
+    worldBindPose[i] = parent < 0 ? local : combine(worldBindPose[parent], local);
+  }
+
+  std::vector<float> invBindAccessor;
+  for (unsigned int i = 0; i < data->skins_count; ++i)
+  {
+    cgltf_skin* skin = &data->skins[i];
+    if (skin->inverse_bind_matrices == 0)
+    {
+      continue;
+    }
+    // whole accessor in one call
+    invBindAccessor.resize(skin->joints_count * 16);
+    UnpackFloats(skin->inverse_bind_matrices, &invBindAccessor[0], 16);
+    for (unsigned int j = 0; j < skin->joints_count; ++j)
+    {
+      mat4 bindMatrix = inverse(mat4(&invBindAccessor[j * 16]));
+      int joint = nodeJoints[skin->joints[j] - data->nodes];
+      worldBindPose[joint] = mat4ToTransform(bindMatrix);
+    }
+  }
+
+  // back to local space relative to each parent's bind transform
+  Pose bindPose = restPose;
+  for (unsigned int i = 0; i < numJoints; ++i)
+  {
+    Transform current = worldBindPose[i];
+    int parent = bindPose.GetParent(i);
+    if (parent >= 0)
+    {
+      current = combine(inverse(worldBindPose[parent]), current);
+    }
+    bindPose.SetLocalTransform(i, current);
+  }
+  return bindPose;
+}
+
+std::vector<std::string> LoadJointNames(cgltf_data* data)
+{
+  std::vector<int> order = GetJointOrder(data);
+  std::vector<std::string> result(order.size(), "EMPTY NODE");
+  for (unsigned int i = 0, size = (unsigned int) order.size(); i < size; ++i)
+  {
+    cgltf_node& node = data->nodes[order[i]];
+    if (node.name != 0)
+    {
+      result[i] = node.name;
+    }
+  }
+  return result;
+}
+
+Skeleton LoadSkeleton(cgltf_data* data)
+{
+  return Skeleton(LoadRestPose(data), LoadBindPose(data), LoadJointNames(data));
+}
+
+// fills a track from one animation channel. times and values are
+// scratch buffers shared by every channel of a file, each accessor
+// is unpacked in one go and the track is sized once
+template<typename T, int N>
+static void TrackFromChannel(Track<T, N>& result, const cgltf_animation_channel& channel,
+  std::vector<float>& times, std::vector<float>& values)
+{
+  cgltf_animation_sampler& sampler = *channel.sampler;
+
+  Interpolation interpolation = Interpolation::Constant;
+  if (sampler.interpolation == cgltf_interpolation_type_linear)
+  {
+    interpolation = Interpolation::Linear;
+  }
+  else if (sampler.interpolation == cgltf_interpolation_type_cubic_spline)
+  {
+    interpolation = Interpolation::Cubic;
+  }
+  bool isSamplerCubic = interpolation == Interpolation::Cubic;
+  result.SetInterpolation(interpolation);
+
+  unsigned int numFrames = (unsigned int) sampler.input->count;
+  times.resize(numFrames);
+  UnpackFloats(sampler.input, &times[0], 1);
+
+  // cubic samplers store in tangent, value, out tangent per frame
+  unsigned int numValues = (unsigned int) (sampler.output->count * N);
+  values.resize(numValues);
+  UnpackFloats(sampler.output, &values[0], N);
+
+  unsigned int stride = isSamplerCubic ? N * 3 : N;
+  if (numValues < numFrames * stride)
+  {
+    std::cout<<"Animation sampler has too few values, skipping\n";
+    result.Resize(0);
+    return;
+  }
+
+  result.Resize(numFrames);
+  for (unsigned int i = 0; i < numFrames; ++i)
+  {
+    const float* base = &values[i * stride];
+    Frame<N>& frame = result[i];
+    frame.m_Time = times[i];
+    for (int c = 0; c < N; ++c)
+    {
+      frame.m_In[c] = isSamplerCubic ? base[c] : 0.0f;
+      frame.m_Value[c] = base[(isSamplerCubic ? N : 0) + c];
+      frame.m_Out[c] = isSamplerCubic ? base[N * 2 + c] : 0.0f;
+    }
+  }
+}
+
+static void ClipFromAnimation(Clip& clip, const cgltf_data* data, const cgltf_animation& animation,
+  const std::vector<int>& nodeJoints, std::vector<float>& times, std::vector<float>& values)
+{
+  if (animation.name != 0)
+  {
+    clip.SetName(animation.name);
+  }
+  // at most one track per channel, so the clip never reallocates
+  clip.Reserve((unsigned int) animation.channels_count);
+
+  for (unsigned int j = 0; j < animation.channels_count; ++j)
+  {
+    cgltf_animation_channel& channel = animation.channels[j];
+    if (channel.target_node == 0 || channel.sampler == 0)
+    {
+      continue;
+    }
+    int joint = nodeJoints[channel.target_node - data->nodes];
+    if (channel.target_path == cgltf_animation_path_type_translation)
+    {
+      TrackFromChannel<vec3, 3>(clip[joint].GetPositionTrack(), channel, times, values);
+    }
+    else if (channel.target_path == cgltf_animation_path_type_rotation)
+    {
+      TrackFromChannel<quat, 4>(clip[joint].GetRotationTrack(), channel, times, values);
+    }
+    else if (channel.target_path == cgltf_animation_path_type_scale)
+    {
+      TrackFromChannel<vec3, 3>(clip[joint].GetScaleTrack(), channel, times, values);
+    }
+  }
+  clip.RecalculateDuration();
+}
+
+std::vector<Clip> LoadAnimationClips(cgltf_data* data)
+{
+  std::vector<int> nodeJoints = GetNodeJoints(data);
+  unsigned int numClips = (unsigned int) data->animations_count;
+  std::vector<Clip> result(numClips);
+  std::vector<float> times;
+  std::vector<float> values;
+
+  for (unsigned int i = 0; i < numClips; ++i)
+  {
+    ClipFromAnimation(result[i], data, data->animations[i], nodeJoints, times, values);
+  }
+  return result;
+}
+
+Clip LoadAnimationClip(cgltf_data* data, unsigned int index)
+{
+  Clip result;
+  if (index >= data->animations_count)
+  {
+    std::cout<<"Animation index out of range: "<<index<<"\n";
+    return result;
+  }
+  std::vector<int> nodeJoints = GetNodeJoints(data);
+  std::vector<float> times;
+  std::vector<float> values;
+  ClipFromAnimation(result, data, data->animations[index], nodeJoints, times, values);
+  return result;
+}
+
+// one primitive into mesh. skinJoints maps the primitive's skin
+// joint indices to skeleton joints, empty for unskinned meshes
+static void MeshFromPrimitive(Mesh& mesh, const cgltf_primitive& primitive,
+  const std::vector<int>& skinJoints, std::vector<unsigned int>& scratch)
+{
+  unsigned int numVerts = 0;
+  for (unsigned int i = 0; i < primitive.attributes_count; ++i)
+  {
+    if (primitive.attributes[i].type == cgltf_attribute_type_position)
+    {
+      numVerts = (unsigned int) primitive.attributes[i].data->count;
+    }
+  }
+
+  for (unsigned int i = 0; i < primitive.attributes_count; ++i)
+  {
+    const cgltf_attribute& attribute = primitive.attributes[i];
+    const cgltf_accessor* accessor = attribute.data;
+    if (attribute.index != 0 || accessor->count != numVerts)
+    {
+      continue;
+    }
+    // vec2/vec3/vec4 are tightly packed floats, unpack straight into them
+    switch (attribute.type)
+    {
+      case cgltf_attribute_type_position:
+        mesh.GetPosition().resize(numVerts);
+        UnpackFloats(accessor, &mesh.GetPosition()[0].x, 3);
+        break;
+      case cgltf_attribute_type_normal:
+        mesh.GetNormal().resize(numVerts);
+        UnpackFloats(accessor, &mesh.GetNormal()[0].x, 3);
+        // quantized normals are only roughly unit length
+        if (accessor->component_type != cgltf_component_type_r_32f)
+        {
+          std::vector<vec3>& normals = mesh.GetNormal();
+          for (unsigned int v = 0; v < numVerts; ++v)
+          {
+            if (lenSqr(normals[v]) > 0.0f)
+            {
+              normals[v] = normalized(normals[v]);
+            }
+          }
+        }
+        break;
+      case cgltf_attribute_type_texcoord:
+        mesh.GetTexCoord().resize(numVerts);
+        UnpackFloats(accessor, &mesh.GetTexCoord()[0].x, 2);
+        break;
+      case cgltf_attribute_type_weights:
+        mesh.GetWeights().resize(numVerts);
+        UnpackFloats(accessor, &mesh.GetWeights()[0].x, 4);
+        break;
+      case cgltf_attribute_type_joints:
+      {
+        scratch.resize(numVerts * 4);
+        UnpackUints(accessor, &scratch[0], 4);
+        std::vector<ivec4>& influences = mesh.GetInfluences();
+        influences.resize(numVerts);
+        int numSkinJoints = (int) skinJoints.size();
+        for (unsigned int v = 0; v < numVerts; ++v)
+        {
+          int joint[4];
+          for (int c = 0; c < 4; ++c)
+          {
+            int index = (int) scratch[v * 4 + c];
+            joint[c] = index < numSkinJoints ? skinJoints[index] : 0;
+            if (joint[c] < 0)
+            {
+              joint[c] = 0;
+            }
+          }
+          influences[v] = ivec4(joint[0], joint[1], joint[2], joint[3]);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  if (primitive.indices != 0)
+  {
+    std::vector<unsigned int>& indices = mesh.GetIndices();
+    indices.resize(primitive.indices->count);
+    if (indices.size() > 0)
+    {
+      UnpackUints(primitive.indices, &indices[0], 1);
+    }
+  }
+}
+
+static unsigned int ReadIndex(const unsigned char* src, cgltf_component_type type)
+{
+  switch (type)
+  {
+    case cgltf_component_type_r_8u:
+      return *src;
+    case cgltf_component_type_r_16u:
+    {
+      unsigned short value;
+      memcpy(&value, src, sizeof(unsigned short));
+      return value;
+    }
+    default:
+    {
+      unsigned int value;
+      memcpy(&value, src, sizeof(unsigned int));
+      return value;
+    }
+  }
+}
+
+// one morph target attribute as vertex, delta pairs. exporters write
+// targets as sparse accessors with no buffer view, zero everywhere
+// but the listed vertices, and only those are read. anything else is
+// unpacked whole into scratch and the non zero deltas picked out
+static void ReadDeltas(const cgltf_accessor* accessor, unsigned int numVerts,
+  std::vector<unsigned int>& outVertices, std::vector<vec3>& outDeltas, std::vector<float>& scratch)
+{
+  outVertices.clear();
+  outDeltas.clear();
+  if (accessor->count != numVerts || accessor->type != cgltf_type_vec3)
+  {
+    return;
+  }
+  if (accessor->is_sparse && accessor->buffer_view == 0)
+  {
+    const cgltf_accessor_sparse& sparse = accessor->sparse;
+    const cgltf_buffer_view* indexView = sparse.indices_buffer_view;
+    const cgltf_buffer_view* valueView = sparse.values_buffer_view;
+    if (indexView->buffer->data == 0 || valueView->buffer->data == 0)
+    {
+      return;
+    }
+    const unsigned char* indices = (const unsigned char*) indexView->buffer->data
+      + indexView->offset + sparse.indices_byte_offset;
+    const unsigned char* values = (const unsigned char*) valueView->buffer->data
+      + valueView->offset + sparse.values_byte_offset;
+    unsigned int indexSize = ComponentSize(sparse.indices_component_type);
+    unsigned int componentSize = ComponentSize(accessor->component_type);
+    bool normalized = accessor->normalized != 0;
+    unsigned int count = (unsigned int) sparse.count;
+    outVertices.reserve(count);
+    outDeltas.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      unsigned int vertex = ReadIndex(indices + i * indexSize, sparse.indices_component_type);
+      if (vertex >= numVerts)
+      {
+        continue;
+      }
+      // sparse values are tightly packed
+      const unsigned char* value = values + i * componentSize * 3;
+      vec3 delta;
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+        delta.v[c] = ComponentToFloat(value + c * componentSize, accessor->component_type, normalized);
+      }
+      outVertices.push_back(vertex);
+      outDeltas.push_back(delta);
+    }
+    return;
+  }
+  scratch.resize(numVerts * 3);
+  UnpackFloats(accessor, &scratch[0], 3);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    const float* d = &scratch[v * 3];
+    if (d[0] != 0.0f || d[1] != 0.0f || d[2] != 0.0f)
+    {
+      outVertices.push_back(v);
+      outDeltas.push_back(vec3(d[0], d[1], d[2]));
+    }
+  }
+}
+
+// position and normal deltas of every target of a primitive, tangent
+// deltas are skipped like tangents are. a vertex with only one of
+// the two gets a zero delta for the other
+static void MorphTargetsFromPrimitive(Mesh& mesh, const cgltf_mesh& source, const cgltf_primitive& primitive,
+  std::vector<float>& scratch)
+{
+  unsigned int numVerts = (unsigned int) mesh.GetPosition().size();
+  std::vector<MorphTarget>& targets = mesh.GetMorphTargets();
+  targets.resize(primitive.targets_count);
+  std::vector<unsigned int> positionVertices;
+  std::vector<vec3> positionDeltas;
+  std::vector<unsigned int> normalVertices;
+  std::vector<vec3> normalDeltas;
+  std::vector<unsigned int> vertices;
+  std::vector<vec3> positions;
+  std::vector<vec3> normals;
+  for (unsigned int t = 0; t < primitive.targets_count; ++t)
+  {
+    const cgltf_morph_target& target = primitive.targets[t];
+    positionVertices.clear();
+    positionDeltas.clear();
+    normalVertices.clear();
+    normalDeltas.clear();
+    for (unsigned int i = 0; i < target.attributes_count; ++i)
+    {
+      const cgltf_attribute& attribute = target.attributes[i];
+      if (attribute.type == cgltf_attribute_type_position)
+      {
+        ReadDeltas(attribute.data, numVerts, positionVertices, positionDeltas, scratch);
+      }
+      else if (attribute.type == cgltf_attribute_type_normal && mesh.GetNormal().size() == numVerts)
+      {
+        ReadDeltas(attribute.data, numVerts, normalVertices, normalDeltas, scratch);
+      }
+    }
+    if (t < source.target_names_count && source.target_names[t] != 0)
+    {
+      targets[t].SetName(source.target_names[t]);
+    }
+    if (normalVertices.size() == 0)
+    {
+      normals.clear();
+      targets[t].Set(positionVertices, positionDeltas, normals);
+      continue;
+    }
+    // both lists ascend (sparse indices have to), merged by vertex
+    vertices.clear();
+    positions.clear();
+    normals.clear();
+    unsigned int p = 0;
+    unsigned int n = 0;
+    unsigned int numPositions = (unsigned int) positionVertices.size();
+    unsigned int numNormals = (unsigned int) normalVertices.size();
+    while (p < numPositions || n < numNormals)
+    {
+      unsigned int vertex = p < numPositions ? positionVertices[p] : normalVertices[n];
+      if (n < numNormals && normalVertices[n] < vertex)
+      {
+        vertex = normalVertices[n];
+      }
+      bool hasPosition = p < numPositions && positionVertices[p] == vertex;
+      bool hasNormal = n < numNormals && normalVertices[n] == vertex;
+      vertices.push_back(vertex);
+      positions.push_back(hasPosition ? positionDeltas[p++] : vec3());
+      normals.push_back(hasNormal ? normalDeltas[n++] : vec3());
+    }
+    targets[t].Set(vertices, positions, normals);
+  }
+}
+
+std::vector<Mesh> LoadCPUMeshes(cgltf_data* data, unsigned int maxInfluences)
+{
+  std::vector<int> nodeJoints = GetNodeJoints(data);
+
+  // count first so the meshes are built in place, a Mesh copy
+  // re-uploads all of its buffers
+  unsigned int numMeshes = 0;
+  for (unsigned int i = 0; i < data->nodes_count; ++i)
+  {
+    cgltf_mesh* mesh = data->nodes[i].mesh;
+    if (mesh == 0)
+    {
+      continue;
+    }
+    for (unsigned int j = 0; j < mesh->primitives_count; ++j)
+    {
+      if (mesh->primitives[j].type == cgltf_primitive_type_triangles)
+      {
+        ++numMeshes;
+      }
+    }
+  }
+
+  std::vector<Mesh> result(numMeshes);
+  std::vector<int> skinJoints;
+  std::vector<unsigned int> scratch;
+  std::vector<float> deltaScratch;
+  unsigned int current = 0;
+  for (unsigned int i = 0; i < data->nodes_count; ++i)
+  {
+    cgltf_node& node = data->nodes[i];
+    if (node.mesh == 0)
+    {
+      continue;
+    }
+    // skin joint index -> skeleton joint, once per node
+    skinJoints.clear();
+    if (node.skin != 0)
+    {
+      skinJoints.resize(node.skin->joints_count);
+      for (unsigned int j = 0; j < node.skin->joints_count; ++j)
+      {
+        skinJoints[j] = nodeJoints[node.skin->joints[j] - data->nodes];
+      }
+    }
+    for (unsigned int j = 0; j < node.mesh->primitives_count; ++j)
+    {
+      cgltf_primitive& primitive = node.mesh->primitives[j];
+      if (primitive.type != cgltf_primitive_type_triangles)
+      {
+        continue;
+      }
+      Mesh& mesh = result[current++];
+      MeshFromPrimitive(mesh, primitive, skinJoints, scratch);
+      if (primitive.targets_count > 0)
+      {
+        MorphTargetsFromPrimitive(mesh, *node.mesh, primitive, deltaScratch);
+      }
+      // before welding, limiting can make more vertices identical
+      LimitInfluences(mesh, maxInfluences);
+      OptimizeMesh(mesh);
+    }
+  }
+  return result;
+}
+
+std::vector<Mesh> LoadMeshes(cgltf_data* data, bool keepCPUData, unsigned int maxInfluences)
+{
+  std::vector<Mesh> result = LoadCPUMeshes(data, maxInfluences);
+  for (unsigned int i = 0, size = (unsigned int) result.size(); i < size; ++i)
+  {
+    result[i].UpdateOpenGLBuffers();
+    if (!keepCPUData)
+    {
+      result[i].ReleaseCPUData();
+    }
+  }
+  return result;
+}
+
+std::vector<QuantizedMesh> LoadQuantizedMeshes(cgltf_data* data, bool keepCPUData, unsigned int maxInfluences)
+{
+  std::vector<Mesh> meshes = LoadCPUMeshes(data, maxInfluences);
+  std::vector<QuantizedMesh> result(meshes.size());
+  for (unsigned int i = 0, size = (unsigned int) meshes.size(); i < size; ++i)
+  {
+    if (!result[i].Set(meshes[i]))
+    {
+      continue;
+    }
+    result[i].UpdateOpenGLBuffers();
+    if (!keepCPUData)
+    {
+      result[i].ReleaseCPUData();
+    }
+  }
+  return result;
+}
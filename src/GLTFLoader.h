@@ -1,6 +1,83 @@
 #ifndef _H_GLTFLOADER_
 #define _H_GLTFLOADER_
 #include "cgltf.h"
-cgltf_data* LoadGLTFFile(const char* path);
+#include "Pose.h"
+#include "Skeleton.h"
+#include "Clip.h"
+#include "Mesh.h"
+#include "QuantizedMesh.h"
+#include "NameTable.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// where a load spent its time, filled in by LoadGLTFFile and
+// LoadTrustedGLTFFile when they are given one
+struct GLTFLoadReport
+{
+  double parseMs;    // reading or mapping the file, parsing the JSON
+  double buffersMs;  // external and base64 buffers
+  double checksumMs; // trusted loads only
+  double validateMs;
+  double totalMs;
+  size_t jsonBytes;
+  size_t bufferBytes;
+  unsigned int numBuffers;
+  uint64_t checksum; // what the file hashed to, trusted loads only
+  bool validated;
+};
+
+// memoryMapped: mmap the file and read buffers in place (see .cpp)
+cgltf_data* LoadGLTFFile(const char* path, bool memoryMapped = false, GLTFLoadReport* report = 0);
+// for files written by our own converter: cgltf_validate is skipped
+// when GetGLTFChecksum of the loaded file matches checksum (recorded
+// by the converter after a validated load). on a mismatch the file
+// is validated like any other and a warning printed, 0 always validates
+cgltf_data* LoadTrustedGLTFFile(const char* path, uint64_t checksum, bool memoryMapped = false,
+  GLTFLoadReport* report = 0);
+// hash of the JSON and the buffer sizes, never 0 in practice. buffer
+// contents aren't hashed, that would cost more than the validation
+// it replaces. catches a stale checksum or a file edited since
+// conversion, not corrupted vertex data
+uint64_t GetGLTFChecksum(cgltf_data* data);
+void PrintLoadReport(const char* path, const GLTFLoadReport& report);
 void FreeGLTTFile(cgltf_data* handle);
+
+// every node in the file becomes a joint. joints are ordered
+// breadth first from the roots so parents always come before
+// their children, GetJointOrder returns the node index of each
+// joint and GetNodeJoints the joint index of each node
+std::vector<int> GetJointOrder(cgltf_data* data);
+std::vector<int> GetNodeJoints(cgltf_data* data);
+// node names by node index, for attachment points on nodes that
+// aren't joints. joint names are on the skeleton (GetJointIndex)
+NameTable LoadNodeTable(cgltf_data* data);
+
+Pose LoadRestPose(cgltf_data* data);
+Pose LoadBindPose(cgltf_data* data);
+std::vector<std::string> LoadJointNames(cgltf_data* data);
+Skeleton LoadSkeleton(cgltf_data* data);
+
+// one clip per animation, tracks are keyed by joint index (see
+// GetJointOrder). morph target weight channels are skipped
+std::vector<Clip> LoadAnimationClips(cgltf_data* data);
+// just one animation, for streaming clips in one at a time
+Clip LoadAnimationClip(cgltf_data* data, unsigned int index);
+
+// one mesh per triangle primitive of every node with a mesh, joint
+// influences are remapped from skin joint indices to skeleton order
+// meshes are uploaded to the GPU, with keepCPUData false the CPU
+// copy is released right after (no CPU skinning for those)
+// each vertex keeps its maxInfluences (1 to 4) biggest weights, sorted
+// and renormalized (LimitInfluences). duplicate vertices are then
+// welded and triangles and vertices reordered for the vertex cache
+// (OptimizeMesh) before anything is uploaded
+// morph targets are kept sparse on the CPU copy (GetMorphTargets),
+// remapped along with the vertices
+std::vector<Mesh> LoadMeshes(cgltf_data* data, bool keepCPUData = true, unsigned int maxInfluences = 4);
+// same meshes without touching GL, for offline tools
+std::vector<Mesh> LoadCPUMeshes(cgltf_data* data, unsigned int maxInfluences = 4);
+// same meshes packed (QuantizedMesh) and uploaded, for crowds that
+// only skin on the GPU. meshes with joints past 255 come back empty
+std::vector<QuantizedMesh> LoadQuantizedMeshes(cgltf_data* data, bool keepCPUData = false, unsigned int maxInfluences = 4);
 #endif
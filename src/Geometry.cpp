@@ -0,0 +1,565 @@
+#include "Geometry.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GEOMETRY_SSE
+#include <emmintrin.h>
+#endif
+
+void normalize(Plane& p)
+{
+  float lenSq = lenSqr(p.normal);
+  if (lenSq < VEC_EPSILON)
+  {
+    return;
+  }
+  float invLen = 1.0f / std::sqrtf(lenSq);
+  p.normal = p.normal * invLen;
+  p.d *= invLen;
+}
+
+// signed distance, positive on the side the normal points to
+float distance(const Plane& p, const vec3& point)
+{
+  return dot(p.normal, point) + p.d;
+}
+
+// Gribb & Hartmann: a point is inside the clip volume when
+// -w <= x, y, z <= w, so every plane is the last row of the matrix
+// plus or minus one of the other rows
+Frustum frustumFromMatrix(const mat4& m)
+{
+  // rows of a column major matrix
+  vec4 r0(m.r0c0, m.r0c1, m.r0c2, m.r0c3);
+  vec4 r1(m.r1c0, m.r1c1, m.r1c2, m.r1c3);
+  vec4 r2(m.r2c0, m.r2c1, m.r2c2, m.r2c3);
+  vec4 r3(m.r3c0, m.r3c1, m.r3c2, m.r3c3);
+
+  Frustum f;
+  f.planes[Frustum::Left]   = Plane(vec3(r3.x + r0.x, r3.y + r0.y, r3.z + r0.z), r3.w + r0.w);
+  f.planes[Frustum::Right]  = Plane(vec3(r3.x - r0.x, r3.y - r0.y, r3.z - r0.z), r3.w - r0.w);
+  f.planes[Frustum::Bottom] = Plane(vec3(r3.x + r1.x, r3.y + r1.y, r3.z + r1.z), r3.w + r1.w);
+  f.planes[Frustum::Top]    = Plane(vec3(r3.x - r1.x, r3.y - r1.y, r3.z - r1.z), r3.w - r1.w);
+  f.planes[Frustum::Near]   = Plane(vec3(r3.x + r2.x, r3.y + r2.y, r3.z + r2.z), r3.w + r2.w);
+  f.planes[Frustum::Far]    = Plane(vec3(r3.x - r2.x, r3.y - r2.y, r3.z - r2.z), r3.w - r2.w);
+  for (int i = 0; i < Frustum::NumPlanes; ++i)
+  {
+    normalize(f.planes[i]);
+  }
+  return f;
+}
+
+// conservative: a sphere is only rejected when it is completely
+// behind one of the planes
+bool intersects(const Frustum& f, const Sphere& s)
+{
+  for (int i = 0; i < Frustum::NumPlanes; ++i)
+  {
+    if (distance(f.planes[i], s.center) < -s.radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the box is projected onto each plane normal, giving it a radius
+// along that normal around its center
+bool intersects(const Frustum& f, const AABB& box)
+{
+  vec3 center = (box.min + box.max) * 0.5f;
+  vec3 extents = (box.max - box.min) * 0.5f;
+  for (int i = 0; i < Frustum::NumPlanes; ++i)
+  {
+    const vec3& n = f.planes[i].normal;
+    float r = std::fabsf(n.x) * extents.x
+            + std::fabsf(n.y) * extents.y
+            + std::fabsf(n.z) * extents.z;
+    if (distance(f.planes[i], center) < -r)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void ClearMask(unsigned int count, std::vector<unsigned int>& outMask)
+{
+  outMask.assign((count + 31) / 32, 0u);
+}
+
+// spheres are 16 bytes (center + radius), so 4 of them transpose into
+// registers of center x, y, z and radius and are tested together
+void frustumCull(const Frustum& f, const Sphere* spheres, unsigned int count, std::vector<unsigned int>& outMask)
+{
+  ClearMask(count, outMask);
+  unsigned int i = 0;
+#ifdef GEOMETRY_SSE
+  static_assert(sizeof(Sphere) == 16, "Sphere must be 4 packed floats");
+  for (; i + 4 <= count; i += 4)
+  {
+    const float* s = &spheres[i].center.x;
+    __m128 cx = _mm_loadu_ps(s + 0);
+    __m128 cy = _mm_loadu_ps(s + 4);
+    __m128 cz = _mm_loadu_ps(s + 8);
+    __m128 r = _mm_loadu_ps(s + 12);
+    _MM_TRANSPOSE4_PS(cx, cy, cz, r);
+    __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+    __m128 outside = _mm_setzero_ps();
+    for (int p = 0; p < Frustum::NumPlanes; ++p)
+    {
+      const Plane& plane = f.planes[p];
+      __m128 d = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.normal.y)))
+        , _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.d)));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negR));
+    }
+    // i is a multiple of 4, so the 4 bits never straddle two words
+    unsigned int visible = (~_mm_movemask_ps(outside)) & 0xf;
+    outMask[i / 32] |= visible << (i % 32);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    if (intersects(f, spheres[i]))
+    {
+      outMask[i / 32] |= 1u << (i % 32);
+    }
+  }
+}
+
+// boxes don't pack into registers as neatly, so each box is tested
+// against the planes in parallel: planes are stored as x, y, z, d
+// lanes, padded to 8 with planes nothing can be behind
+void frustumCull(const Frustum& f, const AABB* boxes, unsigned int count, std::vector<unsigned int>& outMask)
+{
+  ClearMask(count, outMask);
+  unsigned int i = 0;
+#ifdef GEOMETRY_SSE
+  float nx[8], ny[8], nz[8], pd[8];
+  for (int p = 0; p < 8; ++p)
+  {
+    bool real = p < Frustum::NumPlanes;
+    nx[p] = real ? f.planes[p].normal.x : 0.0f;
+    ny[p] = real ? f.planes[p].normal.y : 0.0f;
+    nz[p] = real ? f.planes[p].normal.z : 0.0f;
+    pd[p] = real ? f.planes[p].d : 1.0f;
+  }
+  __m128 nx0 = _mm_loadu_ps(nx), nx1 = _mm_loadu_ps(nx + 4);
+  __m128 ny0 = _mm_loadu_ps(ny), ny1 = _mm_loadu_ps(ny + 4);
+  __m128 nz0 = _mm_loadu_ps(nz), nz1 = _mm_loadu_ps(nz + 4);
+  __m128 pd0 = _mm_loadu_ps(pd), pd1 = _mm_loadu_ps(pd + 4);
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 ax0 = _mm_and_ps(nx0, absMask), ax1 = _mm_and_ps(nx1, absMask);
+  __m128 ay0 = _mm_and_ps(ny0, absMask), ay1 = _mm_and_ps(ny1, absMask);
+  __m128 az0 = _mm_and_ps(nz0, absMask), az1 = _mm_and_ps(nz1, absMask);
+  const __m128 half = _mm_set1_ps(0.5f);
+
+  for (; i < count; ++i)
+  {
+    const AABB& b = boxes[i];
+    __m128 cx = _mm_mul_ps(_mm_set1_ps(b.min.x + b.max.x), half);
+    __m128 cy = _mm_mul_ps(_mm_set1_ps(b.min.y + b.max.y), half);
+    __m128 cz = _mm_mul_ps(_mm_set1_ps(b.min.z + b.max.z), half);
+    __m128 ex = _mm_mul_ps(_mm_set1_ps(b.max.x - b.min.x), half);
+    __m128 ey = _mm_mul_ps(_mm_set1_ps(b.max.y - b.min.y), half);
+    __m128 ez = _mm_mul_ps(_mm_set1_ps(b.max.z - b.min.z), half);
+
+    // distance of the center + projected radius, outside when d + r < 0
+    __m128 d0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx0, cx), _mm_mul_ps(ny0, cy)), _mm_add_ps(_mm_mul_ps(nz0, cz), pd0));
+    __m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax0, ex), _mm_mul_ps(ay0, ey)), _mm_mul_ps(az0, ez));
+    __m128 d1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx1, cx), _mm_mul_ps(ny1, cy)), _mm_add_ps(_mm_mul_ps(nz1, cz), pd1));
+    __m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax1, ex), _mm_mul_ps(ay1, ey)), _mm_mul_ps(az1, ez));
+    __m128 outside = _mm_or_ps(
+        _mm_cmplt_ps(_mm_add_ps(d0, r0), _mm_setzero_ps())
+      , _mm_cmplt_ps(_mm_add_ps(d1, r1), _mm_setzero_ps()));
+    if (_mm_movemask_ps(outside) == 0)
+    {
+      outMask[i / 32] |= 1u << (i % 32);
+    }
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    if (intersects(f, boxes[i]))
+    {
+      outMask[i / 32] |= 1u << (i % 32);
+    }
+  }
+}
+
+// **********************//
+//                       //
+//      Ray queries      //
+//                       //
+// **********************//
+
+Ray screenToRay(const mat4& viewProjection, float ndcX, float ndcY)
+{
+  mat4 inv = inverse(viewProjection);
+  float nearW = 1.0f, farW = 1.0f;
+  vec3 nearPoint = transformPoint(inv, vec3(ndcX, ndcY, -1.0f), nearW);
+  vec3 farPoint = transformPoint(inv, vec3(ndcX, ndcY, 1.0f), farW);
+  nearPoint = nearPoint * (1.0f / nearW);
+  farPoint = farPoint * (1.0f / farW);
+  return Ray(nearPoint, normalized(farPoint - nearPoint));
+}
+
+// with m = origin - center, solve |m + t * dir|^2 = r^2 for t:
+// t^2 + 2bt + c = 0 where b = dot(m, dir) and c = dot(m, m) - r^2
+bool raycast(const Ray& ray, const Sphere& sphere, float& t)
+{
+  vec3 m = ray.origin - sphere.center;
+  float b = dot(m, ray.direction);
+  float c = dot(m, m) - sphere.radius * sphere.radius;
+  // outside and pointing away
+  if (c > 0.0f && b > 0.0f)
+  {
+    return false;
+  }
+  float disc = b * b - c;
+  if (disc < 0.0f)
+  {
+    return false;
+  }
+  t = -b - std::sqrtf(disc);
+  if (t < 0.0f)
+  {
+    // origin inside the sphere
+    t = 0.0f;
+  }
+  return true;
+}
+
+// test the infinite cylinder first, if the hit lies past either end
+// of the segment test the sphere cap on that end instead
+// (Inigo Quilez's capsule intersection)
+bool raycast(const Ray& ray, const Capsule& capsule, float& t)
+{
+  const vec3& rd = ray.direction;
+  vec3 ba = capsule.b - capsule.a;
+  vec3 oa = ray.origin - capsule.a;
+  float baba = dot(ba, ba);
+  float bard = dot(ba, rd);
+  float baoa = dot(ba, oa);
+  float rdoa = dot(rd, oa);
+  float oaoa = dot(oa, oa);
+  float rr = capsule.radius * capsule.radius;
+
+  // origin inside, closest point on the segment is within the radius
+  float u = baba > 0.0f ? baoa / baba : 0.0f;
+  u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+  if (lenSqr(oa - ba * u) <= rr)
+  {
+    t = 0.0f;
+    return true;
+  }
+
+  float a = baba - bard * bard;
+  float b = baba * rdoa - baoa * bard;
+  float c = baba * oaoa - baoa * baoa - rr * baba;
+  float h = b * b - a * c;
+  if (h < 0.0f)
+  {
+    return false;
+  }
+  // a ray parallel to the axis can only enter through a cap, the one
+  // at the start of its direction of travel
+  float y = bard > 0.0f ? -1.0f : baba + 1.0f;
+  if (a > VEC_EPSILON)
+  {
+    float tc = (-b - std::sqrtf(h)) / a;
+    y = baoa + tc * bard;
+    if (y > 0.0f && y < baba)
+    {
+      // entered the body behind the origin
+      if (tc < 0.0f)
+      {
+        return false;
+      }
+      t = tc;
+      return true;
+    }
+  }
+  // otherwise try the cap on the side the hit fell past
+  vec3 oc = (y <= 0.0f) ? oa : ray.origin - capsule.b;
+  b = dot(rd, oc);
+  c = dot(oc, oc) - rr;
+  h = b * b - c;
+  if (h < 0.0f || b > 0.0f)
+  {
+    return false;
+  }
+  t = -b - std::sqrtf(h);
+  return true;
+}
+
+// Moller-Trumbore, solves origin + t * dir = a + u * e1 + v * e2
+bool raycast(const Ray& ray, const Triangle& tri, float& t)
+{
+  vec3 e1 = tri.b - tri.a;
+  vec3 e2 = tri.c - tri.a;
+  vec3 p = cross(ray.direction, e2);
+  float det = dot(e1, p);
+  if (std::fabsf(det) < VEC_EPSILON)
+  {
+    // ray parallel to the triangle
+    return false;
+  }
+  float invDet = 1.0f / det;
+  vec3 s = ray.origin - tri.a;
+  float u = dot(s, p) * invDet;
+  if (u < 0.0f || u > 1.0f)
+  {
+    return false;
+  }
+  vec3 q = cross(s, e1);
+  float v = dot(ray.direction, q) * invDet;
+  if (v < 0.0f || u + v > 1.0f)
+  {
+    return false;
+  }
+  float tt = dot(e2, q) * invDet;
+  if (tt < 0.0f)
+  {
+    return false;
+  }
+  t = tt;
+  return true;
+}
+
+#ifdef GEOMETRY_SSE
+// SSE2 has no blend, pick b where mask is set and a elsewhere
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+}
+
+static inline __m128 Dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+// each lane keeps its own closest hit, merged into hit at the end
+struct NearestLanes
+{
+  __m128 t;
+  __m128 index;
+
+  NearestLanes() : t(_mm_set1_ps(INFINITY)), index(_mm_castsi128_ps(_mm_set1_epi32(-1))) {}
+
+  void Update(__m128 hitMask, __m128 hitT, unsigned int first)
+  {
+    __m128 closer = _mm_and_ps(hitMask, _mm_cmplt_ps(hitT, t));
+    __m128 ids = _mm_castsi128_ps(_mm_add_epi32(_mm_set1_epi32((int) first), _mm_set_epi32(3, 2, 1, 0)));
+    t = Select(closer, t, hitT);
+    index = Select(closer, index, ids);
+  }
+
+  void Merge(RayHit& hit)
+  {
+    float ts[4];
+    int ids[4];
+    _mm_storeu_ps(ts, t);
+    _mm_storeu_si128((__m128i*) ids, _mm_castps_si128(index));
+    for (int i = 0; i < 4; ++i)
+    {
+      // ties go to the lower index like the scalar loop
+      if (ids[i] >= 0 && (hit.index < 0 || ts[i] < hit.distance || (ts[i] == hit.distance && ids[i] < hit.index)))
+      {
+        hit.index = ids[i];
+        hit.distance = ts[i];
+      }
+    }
+  }
+};
+#endif
+
+static inline void Nearest(RayHit& hit, bool didHit, float t, unsigned int index)
+{
+  if (didHit && (hit.index < 0 || t < hit.distance))
+  {
+    hit.index = (int) index;
+    hit.distance = t;
+  }
+}
+
+RayHit raycast(const Ray& ray, const Sphere* spheres, unsigned int count)
+{
+  RayHit hit;
+  unsigned int i = 0;
+#ifdef GEOMETRY_SSE
+  NearestLanes lanes;
+  __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+  __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4)
+  {
+    const float* s = &spheres[i].center.x;
+    __m128 cx = _mm_loadu_ps(s + 0);
+    __m128 cy = _mm_loadu_ps(s + 4);
+    __m128 cz = _mm_loadu_ps(s + 8);
+    __m128 r = _mm_loadu_ps(s + 12);
+    _MM_TRANSPOSE4_PS(cx, cy, cz, r);
+
+    __m128 mx = _mm_sub_ps(ox, cx), my = _mm_sub_ps(oy, cy), mz = _mm_sub_ps(oz, cz);
+    __m128 b = Dot3(mx, my, mz, dx, dy, dz);
+    __m128 c = _mm_sub_ps(Dot3(mx, my, mz, mx, my, mz), _mm_mul_ps(r, r));
+    __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), c);
+    __m128 away = _mm_and_ps(_mm_cmpgt_ps(c, zero), _mm_cmpgt_ps(b, zero));
+    __m128 hitMask = _mm_andnot_ps(away, _mm_cmpge_ps(disc, zero));
+    __m128 t = _mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(disc, zero)));
+    lanes.Update(hitMask, _mm_max_ps(t, zero), i);
+  }
+  lanes.Merge(hit);
+#endif
+  for (; i < count; ++i)
+  {
+    float t;
+    bool didHit = raycast(ray, spheres[i], t);
+    Nearest(hit, didHit, t, i);
+  }
+  return hit;
+}
+
+RayHit raycast(const Ray& ray, const Capsule* capsules, unsigned int count)
+{
+  RayHit hit;
+  unsigned int i = 0;
+#ifdef GEOMETRY_SSE
+  NearestLanes lanes;
+  __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+  __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 eps = _mm_set1_ps(VEC_EPSILON);
+  for (; i + 4 <= count; i += 4)
+  {
+    const Capsule* cap = capsules + i;
+    __m128 ax = _mm_setr_ps(cap[0].a.x, cap[1].a.x, cap[2].a.x, cap[3].a.x);
+    __m128 ay = _mm_setr_ps(cap[0].a.y, cap[1].a.y, cap[2].a.y, cap[3].a.y);
+    __m128 az = _mm_setr_ps(cap[0].a.z, cap[1].a.z, cap[2].a.z, cap[3].a.z);
+    __m128 bx = _mm_setr_ps(cap[0].b.x, cap[1].b.x, cap[2].b.x, cap[3].b.x);
+    __m128 by = _mm_setr_ps(cap[0].b.y, cap[1].b.y, cap[2].b.y, cap[3].b.y);
+    __m128 bz = _mm_setr_ps(cap[0].b.z, cap[1].b.z, cap[2].b.z, cap[3].b.z);
+    __m128 r = _mm_setr_ps(cap[0].radius, cap[1].radius, cap[2].radius, cap[3].radius);
+    __m128 rr = _mm_mul_ps(r, r);
+
+    __m128 bax = _mm_sub_ps(bx, ax), bay = _mm_sub_ps(by, ay), baz = _mm_sub_ps(bz, az);
+    __m128 oax = _mm_sub_ps(ox, ax), oay = _mm_sub_ps(oy, ay), oaz = _mm_sub_ps(oz, az);
+    __m128 baba = Dot3(bax, bay, baz, bax, bay, baz);
+    __m128 bard = Dot3(bax, bay, baz, dx, dy, dz);
+    __m128 baoa = Dot3(bax, bay, baz, oax, oay, oaz);
+    __m128 rdoa = Dot3(dx, dy, dz, oax, oay, oaz);
+    __m128 oaoa = Dot3(oax, oay, oaz, oax, oay, oaz);
+
+    // origin inside
+    __m128 u = _mm_div_ps(baoa, _mm_max_ps(baba, eps));
+    u = _mm_min_ps(_mm_max_ps(u, zero), one);
+    __m128 ix = _mm_sub_ps(oax, _mm_mul_ps(bax, u));
+    __m128 iy = _mm_sub_ps(oay, _mm_mul_ps(bay, u));
+    __m128 iz = _mm_sub_ps(oaz, _mm_mul_ps(baz, u));
+    __m128 inside = _mm_cmple_ps(Dot3(ix, iy, iz, ix, iy, iz), rr);
+
+    // infinite cylinder
+    __m128 a = _mm_sub_ps(baba, _mm_mul_ps(bard, bard));
+    __m128 b = _mm_sub_ps(_mm_mul_ps(baba, rdoa), _mm_mul_ps(baoa, bard));
+    __m128 c = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(baba, oaoa), _mm_mul_ps(baoa, baoa)), _mm_mul_ps(rr, baba));
+    __m128 h = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+    __m128 cylinderValid = _mm_and_ps(_mm_cmpge_ps(h, zero), _mm_cmpgt_ps(a, eps));
+    __m128 safeA = Select(cylinderValid, one, a);
+    __m128 tc = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(h, zero))), safeA);
+    // parallel lanes pick a cap the same way the scalar path does
+    __m128 parallelY = Select(_mm_cmpgt_ps(bard, zero), _mm_add_ps(baba, one), _mm_set1_ps(-1.0f));
+    __m128 y = Select(cylinderValid, parallelY, _mm_add_ps(baoa, _mm_mul_ps(tc, bard)));
+    __m128 inBody = _mm_and_ps(cylinderValid, _mm_and_ps(_mm_cmpgt_ps(y, zero), _mm_cmplt_ps(y, baba)));
+    __m128 bodyHit = _mm_and_ps(inBody, _mm_cmpge_ps(tc, zero));
+
+    // sphere cap on the side of y
+    __m128 useA = _mm_cmple_ps(y, zero);
+    __m128 ocx = Select(useA, _mm_sub_ps(ox, bx), oax);
+    __m128 ocy = Select(useA, _mm_sub_ps(oy, by), oay);
+    __m128 ocz = Select(useA, _mm_sub_ps(oz, bz), oaz);
+    __m128 cb = Dot3(dx, dy, dz, ocx, ocy, ocz);
+    __m128 cc = _mm_sub_ps(Dot3(ocx, ocy, ocz, ocx, ocy, ocz), rr);
+    __m128 ch = _mm_sub_ps(_mm_mul_ps(cb, cb), cc);
+    __m128 capHit = _mm_andnot_ps(_mm_or_ps(inBody, _mm_cmpgt_ps(cb, zero)), _mm_cmpge_ps(ch, zero));
+    __m128 tcap = _mm_sub_ps(_mm_sub_ps(zero, cb), _mm_sqrt_ps(_mm_max_ps(ch, zero)));
+
+    // the whole test fails early when the infinite cylinder is missed
+    __m128 missed = _mm_and_ps(_mm_cmplt_ps(h, zero), _mm_cmpgt_ps(a, eps));
+    __m128 hitMask = _mm_or_ps(inside, _mm_andnot_ps(missed, _mm_or_ps(bodyHit, capHit)));
+    __m128 t = Select(bodyHit, tcap, tc);
+    lanes.Update(hitMask, _mm_andnot_ps(inside, t), i);
+  }
+  lanes.Merge(hit);
+#endif
+  for (; i < count; ++i)
+  {
+    float t;
+    bool didHit = raycast(ray, capsules[i], t);
+    Nearest(hit, didHit, t, i);
+  }
+  return hit;
+}
+
+RayHit raycast(const Ray& ray, const Triangle* triangles, unsigned int count)
+{
+  RayHit hit;
+  unsigned int i = 0;
+#ifdef GEOMETRY_SSE
+  NearestLanes lanes;
+  __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+  __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 eps = _mm_set1_ps(VEC_EPSILON);
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  for (; i + 4 <= count; i += 4)
+  {
+    const Triangle* tri = triangles + i;
+    __m128 ax = _mm_setr_ps(tri[0].a.x, tri[1].a.x, tri[2].a.x, tri[3].a.x);
+    __m128 ay = _mm_setr_ps(tri[0].a.y, tri[1].a.y, tri[2].a.y, tri[3].a.y);
+    __m128 az = _mm_setr_ps(tri[0].a.z, tri[1].a.z, tri[2].a.z, tri[3].a.z);
+    __m128 e1x = _mm_sub_ps(_mm_setr_ps(tri[0].b.x, tri[1].b.x, tri[2].b.x, tri[3].b.x), ax);
+    __m128 e1y = _mm_sub_ps(_mm_setr_ps(tri[0].b.y, tri[1].b.y, tri[2].b.y, tri[3].b.y), ay);
+    __m128 e1z = _mm_sub_ps(_mm_setr_ps(tri[0].b.z, tri[1].b.z, tri[2].b.z, tri[3].b.z), az);
+    __m128 e2x = _mm_sub_ps(_mm_setr_ps(tri[0].c.x, tri[1].c.x, tri[2].c.x, tri[3].c.x), ax);
+    __m128 e2y = _mm_sub_ps(_mm_setr_ps(tri[0].c.y, tri[1].c.y, tri[2].c.y, tri[3].c.y), ay);
+    __m128 e2z = _mm_sub_ps(_mm_setr_ps(tri[0].c.z, tri[1].c.z, tri[2].c.z, tri[3].c.z), az);
+
+    // p = cross(dir, e2)
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = Dot3(e1x, e1y, e1z, px, py, pz);
+    __m128 valid = _mm_cmpgt_ps(_mm_and_ps(det, absMask), eps);
+    __m128 invDet = _mm_div_ps(one, Select(valid, one, det));
+
+    __m128 sx = _mm_sub_ps(ox, ax), sy = _mm_sub_ps(oy, ay), sz = _mm_sub_ps(oz, az);
+    __m128 u = _mm_mul_ps(Dot3(sx, sy, sz, px, py, pz), invDet);
+    // q = cross(s, e1)
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 v = _mm_mul_ps(Dot3(dx, dy, dz, qx, qy, qz), invDet);
+    __m128 t = _mm_mul_ps(Dot3(e2x, e2y, e2z, qx, qy, qz), invDet);
+
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+    valid = _mm_and_ps(valid, _mm_cmple_ps(u, one));
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+    valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(t, zero));
+    lanes.Update(valid, t, i);
+  }
+  lanes.Merge(hit);
+#endif
+  for (; i < count; ++i)
+  {
+    float t;
+    bool didHit = raycast(ray, triangles[i], t);
+    Nearest(hit, didHit, t, i);
+  }
+  return hit;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Math.h"
+#include <vector>
+
+// bounding volumes and planes used for culling
+
+struct Sphere
+{
+  vec3 center;
+  float radius;
+  inline Sphere() : center(vec3(0, 0, 0)), radius(0.0f) {}
+  inline Sphere(const vec3& c, float r) : center(c), radius(r) {}
+};
+
+struct AABB
+{
+  vec3 min;
+  vec3 max;
+  inline AABB() : min(vec3(0, 0, 0)), max(vec3(0, 0, 0)) {}
+  inline AABB(const vec3& _min, const vec3& _max) : min(_min), max(_max) {}
+};
+
+// points p on the plane satisfy dot(normal, p) + d == 0
+// the normal points to the positive (inside) half space
+struct Plane
+{
+  vec3 normal;
+  float d;
+  inline Plane() : normal(vec3(0, 1, 0)), d(0.0f) {}
+  inline Plane(const vec3& n, float _d) : normal(n), d(_d) {}
+};
+
+// six planes with normals pointing into the frustum
+struct Frustum
+{
+  enum { Left, Right, Bottom, Top, Near, Far, NumPlanes };
+  Plane planes[NumPlanes];
+};
+
+void normalize(Plane& p);
+float distance(const Plane& p, const vec3& point);
+Frustum frustumFromMatrix(const mat4& viewProjection);
+bool intersects(const Frustum& f, const Sphere& s);
+bool intersects(const Frustum& f, const AABB& box);
+
+// batched frustum tests (SIMD where available). bit i of outMask is
+// set when object i is at least partly inside the frustum
+// outMask is resized to (count + 31) / 32 words
+void frustumCull(const Frustum& f, const Sphere* spheres, unsigned int count, std::vector<unsigned int>& outMask);
+void frustumCull(const Frustum& f, const AABB* boxes, unsigned int count, std::vector<unsigned int>& outMask);
+
+// **********************//
+//                       //
+//      Ray queries      //
+//                       //
+// **********************//
+
+// direction is expected to be normalized
+struct Ray
+{
+  vec3 origin;
+  vec3 direction;
+  inline Ray() : origin(vec3(0, 0, 0)), direction(vec3(0, 0, -1)) {}
+  inline Ray(const vec3& o, const vec3& d) : origin(o), direction(d) {}
+};
+
+// a sphere swept along the segment a - b
+struct Capsule
+{
+  vec3 a;
+  vec3 b;
+  float radius;
+  inline Capsule() : a(vec3(0, 0, 0)), b(vec3(0, 1, 0)), radius(0.5f) {}
+  inline Capsule(const vec3& _a, const vec3& _b, float r) : a(_a), b(_b), radius(r) {}
+};
+
+struct Triangle
+{
+  vec3 a;
+  vec3 b;
+  vec3 c;
+  inline Triangle() {}
+  inline Triangle(const vec3& _a, const vec3& _b, const vec3& _c) : a(_a), b(_b), c(_c) {}
+};
+
+// index of the closest object hit and the distance along the ray
+// index is -1 when nothing was hit
+struct RayHit
+{
+  int index;
+  float distance;
+  inline RayHit() : index(-1), distance(0.0f) {}
+};
+
+// picking ray through a point in normalized device coordinates
+// (-1 to 1, y up), from the near plane towards the far plane
+Ray screenToRay(const mat4& viewProjection, float ndcX, float ndcY);
+
+// single tests, t is the distance to the first hit in front of the
+// ray origin (0 if the origin is inside a sphere or capsule)
+bool raycast(const Ray& ray, const Sphere& sphere, float& t);
+bool raycast(const Ray& ray, const Capsule& capsule, float& t);
+bool raycast(const Ray& ray, const Triangle& triangle, float& t);
+
+// nearest hit in an array (SIMD where available), triangles are
+// double sided
+RayHit raycast(const Ray& ray, const Sphere* spheres, unsigned int count);
+RayHit raycast(const Ray& ray, const Capsule* capsules, unsigned int count);
+RayHit raycast(const Ray& ray, const Triangle* triangles, unsigned int count);
@@ -0,0 +1,257 @@
+#include "Half.h"
+#include <cstring>
+
+// the batched Transform conversions treat both structs as flat streams
+static_assert(sizeof(Transform) == 10 * sizeof(float), "Transform must be 10 packed floats");
+static_assert(sizeof(HalfTransform) == 10 * sizeof(half), "HalfTransform must be 10 packed halves");
+
+#if defined(__F16C__)
+#define HALF_F16C
+#include <immintrin.h>
+#endif
+
+// software conversions, bit-identical to F16C: both round to nearest
+// even and handle denormals, infinity and NaN payloads the same way
+// based on Fabian Giesen's float_to_half_fast3_rtne / half_to_float
+
+static unsigned short FloatToHalfBits(float value)
+{
+  const unsigned int f32Infinity = 255u << 23;
+  const unsigned int f16Max = (127u + 16u) << 23;
+  const unsigned int denormMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  unsigned int f;
+  memcpy(&f, &value, 4);
+  unsigned int sign = f & 0x80000000u;
+  f ^= sign;
+
+  unsigned short out;
+  if (f >= f16Max)
+  {
+    // too big for a half: infinity, or NaN with the top of its payload
+    // kept and the quiet bit set, like vcvtps2ph
+    out = f > f32Infinity ? (unsigned short) (0x7e00 | ((f >> 13) & 0x3ff)) : 0x7c00;
+  }
+  else if (f < (113u << 23))
+  {
+    // result is a denormal, let the float adder do the rounding
+    float ff, denormMagic;
+    memcpy(&ff, &f, 4);
+    memcpy(&denormMagic, &denormMagicBits, 4);
+    ff += denormMagic;
+    memcpy(&f, &ff, 4);
+    out = (unsigned short) (f - denormMagicBits);
+  }
+  else
+  {
+    // rebias the exponent and round the mantissa to nearest even
+    unsigned int mantissaOdd = (f >> 13) & 1;
+    f += ((unsigned int) (15 - 127) << 23) + 0xfff;
+    f += mantissaOdd;
+    out = (unsigned short) (f >> 13);
+  }
+  return out | (unsigned short) (sign >> 16);
+}
+
+static float HalfBitsToFloat(unsigned short h)
+{
+  const unsigned int shiftedExp = 0x7c00u << 13;
+  const unsigned int magicBits = 113u << 23;
+
+  unsigned int o = (h & 0x7fffu) << 13;
+  unsigned int exp = shiftedExp & o;
+  o += (127u - 15u) << 23;
+  if (exp == shiftedExp)
+  {
+    // infinity or NaN, NaNs come out quiet like vcvtph2ps
+    o += (128u - 16u) << 23;
+    if (o & 0x7fffffu)
+    {
+      o |= 0x400000u;
+    }
+  }
+  else if (exp == 0)
+  {
+    // zero or denormal, renormalize with a float subtract
+    o += 1u << 23;
+    float f, magic;
+    memcpy(&f, &o, 4);
+    memcpy(&magic, &magicBits, 4);
+    f -= magic;
+    memcpy(&o, &f, 4);
+  }
+  o |= (unsigned int) (h & 0x8000u) << 16;
+  float out;
+  memcpy(&out, &o, 4);
+  return out;
+}
+
+half floatToHalf(float f)
+{
+  return half(FloatToHalfBits(f));
+}
+
+float halfToFloat(half h)
+{
+  return HalfBitsToFloat(h.bits);
+}
+
+hvec2 toHalf(const vec2& v)
+{
+  hvec2 out;
+  floatToHalf(v.v, &out.x, 2);
+  return out;
+}
+
+hvec3 toHalf(const vec3& v)
+{
+  hvec3 out;
+  floatToHalf(v.v, &out.x, 3);
+  return out;
+}
+
+hquat toHalf(const quat& q)
+{
+  hquat out;
+  floatToHalf(q.v, &out.x, 4);
+  return out;
+}
+
+HalfTransform toHalf(const Transform& t)
+{
+  HalfTransform out;
+  toHalf(&t, &out, 1);
+  return out;
+}
+
+vec2 toFloat(const hvec2& v)
+{
+  vec2 out;
+  halfToFloat(&v.x, out.v, 2);
+  return out;
+}
+
+vec3 toFloat(const hvec3& v)
+{
+  vec3 out;
+  halfToFloat(&v.x, out.v, 3);
+  return out;
+}
+
+quat toFloat(const hquat& q)
+{
+  quat out;
+  halfToFloat(&q.x, out.v, 4);
+  return out;
+}
+
+Transform toFloat(const HalfTransform& t)
+{
+  Transform out;
+  toFloat(&t, &out, 1);
+  return out;
+}
+
+// the batched versions work on plain float / half streams
+// vec3, quat and their half versions are tightly packed, so an array
+// of them is just a longer stream
+void floatToHalf(const float* in, half* out, unsigned int count)
+{
+  unsigned int i = 0;
+#ifdef HALF_F16C
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 f = _mm256_loadu_ps(in + i);
+    __m128i h = _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128((__m128i*) (out + i), h);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    out[i].bits = FloatToHalfBits(in[i]);
+  }
+}
+
+void halfToFloat(const half* in, float* out, unsigned int count)
+{
+  unsigned int i = 0;
+#ifdef HALF_F16C
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i h = _mm_loadu_si128((const __m128i*) (in + i));
+    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    out[i] = HalfBitsToFloat(in[i].bits);
+  }
+}
+
+void toHalf(const vec2* in, hvec2* out, unsigned int count)
+{
+  floatToHalf(in[0].v, &out[0].x, count * 2);
+}
+
+void toHalf(const vec3* in, hvec3* out, unsigned int count)
+{
+  floatToHalf(in[0].v, &out[0].x, count * 3);
+}
+
+void toHalf(const quat* in, hquat* out, unsigned int count)
+{
+  floatToHalf(in[0].v, &out[0].x, count * 4);
+}
+
+void toFloat(const hvec3* in, vec3* out, unsigned int count)
+{
+  halfToFloat(&in[0].x, out[0].v, count * 3);
+}
+
+void toFloat(const hquat* in, quat* out, unsigned int count)
+{
+  halfToFloat(&in[0].x, out[0].v, count * 4);
+}
+
+// a Transform is 10 floats and a HalfTransform 10 halves, in the same
+// order, so whole arrays convert as one stream
+void toHalf(const Transform* in, HalfTransform* out, unsigned int count)
+{
+  floatToHalf(in[0].position.v, &out[0].position.x, count * 10);
+}
+
+// rotations come back slightly off unit length, renormalize them
+void toFloat(const HalfTransform* in, Transform* out, unsigned int count)
+{
+  halfToFloat(&in[0].position.x, out[0].position.v, count * 10);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    normalize(out[i].rotation);
+  }
+}
+
+// aligned transforms have padding between members, so they go
+// through a small packed buffer to keep the streamed conversion
+void toHalf(const TransformA* in, HalfTransform* out, unsigned int count)
+{
+  const unsigned int BATCH = 64;
+  Transform packed[BATCH];
+  for (unsigned int i = 0; i < count; i += BATCH)
+  {
+    unsigned int n = count - i < BATCH ? count - i : BATCH;
+    toTransform(in + i, packed, n);
+    toHalf(packed, out + i, n);
+  }
+}
+
+void toFloat(const HalfTransform* in, TransformA* out, unsigned int count)
+{
+  const unsigned int BATCH = 64;
+  Transform packed[BATCH];
+  for (unsigned int i = 0; i < count; i += BATCH)
+  {
+    unsigned int n = count - i < BATCH ? count - i : BATCH;
+    toFloat(in + i, packed, n);
+    toTransformA(packed, out + i, n);
+  }
+}
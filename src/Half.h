@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Transform.h"
+
+// half precision (fp16) storage types
+// these are for storing and uploading data only, there is no math
+// on them: convert to float, do the work, convert back
+// a half has an 11 bit mantissa, so positions lose precision quickly
+// away from the origin (steps of ~0.008 at 10 units)
+
+struct half
+{
+  unsigned short bits;
+  inline half() : bits(0) {}
+  explicit inline half(unsigned short _bits) : bits(_bits) {}
+};
+
+struct hvec2
+{
+  half x;
+  half y;
+};
+
+struct hvec3
+{
+  half x;
+  half y;
+  half z;
+};
+
+struct hquat
+{
+  half x;
+  half y;
+  half z;
+  half w;
+};
+
+// half of the 40 bytes of a Transform
+struct HalfTransform
+{
+  hvec3 position;
+  hquat rotation;
+  hvec3 scale;
+};
+
+half floatToHalf(float f);
+float halfToFloat(half h);
+hvec2 toHalf(const vec2& v);
+hvec3 toHalf(const vec3& v);
+hquat toHalf(const quat& q);
+HalfTransform toHalf(const Transform& t);
+vec2 toFloat(const hvec2& v);
+vec3 toFloat(const hvec3& v);
+quat toFloat(const hquat& q);
+Transform toFloat(const HalfTransform& t);
+
+// batched conversions, F16C is used when the compiler targets it
+// (-mf16c or -march=native), otherwise a portable bit twiddling path
+void floatToHalf(const float* in, half* out, unsigned int count);
+void halfToFloat(const half* in, float* out, unsigned int count);
+void toHalf(const vec2* in, hvec2* out, unsigned int count);
+void toHalf(const vec3* in, hvec3* out, unsigned int count);
+void toHalf(const quat* in, hquat* out, unsigned int count);
+void toHalf(const Transform* in, HalfTransform* out, unsigned int count);
+void toFloat(const hvec3* in, vec3* out, unsigned int count);
+void toFloat(const hquat* in, quat* out, unsigned int count);
+void toFloat(const HalfTransform* in, Transform* out, unsigned int count);
+void toHalf(const TransformA* in, HalfTransform* out, unsigned int count);
+void toFloat(const HalfTransform* in, TransformA* out, unsigned int count);
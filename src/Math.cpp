@@ -2,6 +2,12 @@
 #include <cmath>
 #include <iostream>
 
+// SSE2 is always there on x86-64, other targets use the scalar loops
+#if defined(__SSE2__) || defined(_M_X64)
+#define MATH_SSE
+#include <emmintrin.h>
+#endif
+
 // macro for matrix mult
 #define M4D(aRow, bCol) \
     a.v[0 * 4 + aRow] * b.v[bCol * 4 + 0] + \
@@ -23,11 +29,24 @@
 
 // macro for inverse of a mat4 to avoid lower order matrices
 #define M4_3X3MINOR(x, c0, c1, c2, r0, r1, r2) \
-    (x[c0*4*r0] * (x[c1*4+r1] * x[c2*4+r2] - x[c1*4+r2] * \
+    (x[c0*4+r0] * (x[c1*4+r1] * x[c2*4+r2] - x[c1*4+r2] * \
     x[c2*4+r1]) - x[c1*4+r0]*(x[c0*4+r1] * x[c2*4+r2] -  \
     x[c0*4+r2] * x[c2*4+r1]) + x[c2*4+r0]*(x[c0*4+r1] * \
     x[c1*4+r2] - x[c0*4+r2] * x[c1*4+r1]))
 
+// trig used by angles, slerp and quat powers
+// building with -DMATH_FAST_TRIG swaps libm for the polynomial
+// approximations below (see "Fast trig approximations")
+#ifdef MATH_FAST_TRIG
+#define MATH_SIN(x) fastSin(x)
+#define MATH_COS(x) fastCos(x)
+#define MATH_ACOS(x) fastAcos(x)
+#else
+#define MATH_SIN(x) std::sinf(x)
+#define MATH_COS(x) std::cosf(x)
+#define MATH_ACOS(x) std::acosf(x)
+#endif
+
 // **********************//
 //                       //
 //   vector2 operations  //
@@ -175,7 +194,7 @@ float angle(const vec3& a, const vec3& b)
 
   float dot = a.x * b.x + a.y * b.y + a.z * b.z;
 
-  acosf(dot / (std::sqrtf(aLenSq) * std::sqrtf(bLenSq)));
+  return MATH_ACOS(dot / (std::sqrtf(aLenSq) * std::sqrtf(bLenSq)));
 }
 
 // project a onto b (get part of a in direction of b)
@@ -252,9 +271,9 @@ vec3 slerp(const vec3& s, const vec3& e, float t)
   vec3 from = normalized(s);
   vec3 to   = normalized(e);
   float theta = angle(from, to);
-  float sin_theta = sinf(theta);
-  float a = sinf((1.0f - t) * theta) / sin_theta;
-  float b = sinf(t * theta) / sin_theta;
+  float sin_theta = MATH_SIN(theta);
+  float a = MATH_SIN((1.0f - t) * theta) / sin_theta;
+  float b = MATH_SIN(t * theta) / sin_theta;
   return from * a + to * b;
 }
 
@@ -379,7 +398,7 @@ mat4 transposed(const mat4& m)
 {
     return mat4(
         m.xx, m.yx, m.zx, m.tx
-      , m.xy, m.yy, m.yz, m.ty
+      , m.xy, m.yy, m.zy, m.ty
       , m.xz, m.yz, m.zz, m.tz
       , m.xw, m.yw, m.zw, m.tw
     );
@@ -462,7 +481,7 @@ mat4 frustum(float l, float r, float b, float t, float n, float f)
     return mat4();
   }
   return mat4(
-    (2.0f * n) / (r - 1), 0, 0, 0
+    (2.0f * n) / (r - l), 0, 0, 0
     , 0, (2.0f * n) / (t - b), 0, 0
     , (r+l)/(r-l), (t+b)/(t-b), (-(f+n))/(f-n), -1
     , 0, 0, (-2*f*n) / (f-n), 0
@@ -533,12 +552,12 @@ quat angleAxis(float angle, const vec3& axis)
   // divide by 2 to map quat range to sin/cos
   // since quat has a period of 720 degrees
   // and sin/cos has period of 360 degrees
-  float s = std::sinf(angle * 0.5f);
+  float s = MATH_SIN(angle * 0.5f);
   return quat(
       norm.x * s
     , norm.y * s
     , norm.z * s
-    , std::cosf(angle * 0.5f)
+    , MATH_COS(angle * 0.5f)
   );
 }
 
@@ -547,7 +566,7 @@ quat fromTo(const vec3& from, const vec3& to)
   // normalize and makes sure they are not the same vector
   vec3 f = normalized(from);
   vec3 t = normalized(to);
-  if (f == t){return quat();}
+  if (f == t){return quat(0, 0, 0, 1);}
 
   // check whether vecs are opposite each other
   // if yes, most orthogonal axis of FROM vec
@@ -588,7 +607,7 @@ vec3 getAxis(const quat& quat)
 
 float getAngle(const quat& quat)
 {
-  return 2.0f * std::acosf(quat.w);
+  return 2.0f * MATH_ACOS(quat.w);
 }
 
 quat operator+(const quat& a, const quat& b)
@@ -729,7 +748,7 @@ quat operator*(const quat& q1, const quat& q2)
 {
   return quat(
       q2.x*q1.w + q2.y*q1.z - q2.z*q1.y + q2.w*q1.x
-    , -q2.x*q1.z + q2.w*q1.x + q2.z*q1.x + q2.w*q1.y
+    , -q2.x*q1.z + q2.y*q1.w + q2.z*q1.x + q2.w*q1.y
     , q2.x*q1.y - q2.y*q1.x + q2.z*q1.w + q2.w*q1.z
     , -q2.x*q1.x - q2.y*q1.y - q2.z*q1.z + q2.w*q1.w
   );
@@ -778,10 +797,10 @@ quat nlerp(const quat& from, const quat& to, float t)
 // and a new quat built from the adjusted angle & axis
 quat operator^(const quat& q, float f)
 {
-  float angle = 2.0f * std::acosf(q.scalar);
+  float angle = 2.0f * MATH_ACOS(q.scalar);
   vec3 axis = normalized(q.vector);
-  float halfCos = std::cosf(f * angle * 0.5f);
-  float halfSin = std::sinf(f * angle * 0.5f);
+  float halfCos = MATH_COS(f * angle * 0.5f);
+  float halfSin = MATH_SIN(f * angle * 0.5f);
   return quat(
       axis.x * halfSin
     , axis.y * halfSin
@@ -795,14 +814,19 @@ quat operator^(const quat& q, float f)
 // // assumes both quats in desired neighborhood
 quat slerp(const quat& start, const quat& end, float t)
 {
+#ifdef MATH_FAST_TRIG
+    return fastSlerp(start, end, t);
+#else
     if(std::fabsf(dot(start, end)) > 1.0f - QUAT_EPSILON)
     {
       return nlerp(start, end, t);
     }
     // could use conjugate instead of inverse since
     // input vecs to slerp SHOULD BE NORMALIZED
+    // the left quat is applied first: start, then part of the delta
     quat delta = inverse(start) * end;
-    return normalized((delta ^ t) * start);
+    return normalized(start * (delta ^ t));
+#endif
 }
 
 // rotation to lookAt
@@ -840,29 +864,406 @@ quat lookRotation(const vec3& direction, const vec3& up)
 // 1st column is right vec
 // 2nd column is up vec
 // 3rd column is forward vec
+// closed form of rotating the three basis vectors by q,
+// same result as q * vec3(1,0,0) etc without the generic
+// quat * vec3 per column
 mat4 quatToMat4(const quat& q)
 {
-    vec3 r = q * vec3(1, 0, 0);
-    vec3 u = q * vec3(0, 1, 0);
-    vec3 f = q * vec3(0, 0, 1);
-    return mat4(
-        r.x, r.y, r.z, 0
-      , u.x, u.y, u.z, 0
-      , f.x, f.y, f.z, 0
-      , 0  , 0  , 0  , 1
-    );
+  float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+  float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+  float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+  return mat4(
+      1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0
+    , 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0
+    , 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0
+    , 0, 0, 0, 1
+  );
 }
 
 // a matrix stores both rotation and scale data
-// using same components, so need to normalize basis
-// vectors and the cross product needs to be used to
-// make sure vecs are orthogonal
+// using same components, so the basis vectors are
+// normalized first. after that it's the usual trace
+// method, branching on the largest diagonal element
+// so the sqrt never gets a tiny (or negative) input,
+// which also covers 180 degree rotations
 quat mat4ToQuat(const mat4& m)
 {
-  vec3 up = normalized(vec3(m.up.x, m.up.y, m.up.z));
-  vec3 forward = normalized(vec3(m.forward.x, m.forward.y, m.forward.z));
-  vec3 right = cross(up, forward);
+  vec3 r = normalized(vec3(m.right.x, m.right.y, m.right.z));
+  vec3 u = normalized(vec3(m.up.x, m.up.y, m.up.z));
+  vec3 f = normalized(vec3(m.forward.x, m.forward.y, m.forward.z));
+
+  // column vectors, so element (row, col) is col.row
+  float trace = r.x + u.y + f.z;
+  quat out;
+  if (trace > 0.0f)
+  {
+    float s = std::sqrtf(trace + 1.0f) * 2.0f;
+    out = quat((u.z - f.y) / s, (f.x - r.z) / s, (r.y - u.x) / s, 0.25f * s);
+  }
+  else if (r.x > u.y && r.x > f.z)
+  {
+    float s = std::sqrtf(1.0f + r.x - u.y - f.z) * 2.0f;
+    out = quat(0.25f * s, (u.x + r.y) / s, (f.x + r.z) / s, (u.z - f.y) / s);
+  }
+  else if (u.y > f.z)
+  {
+    float s = std::sqrtf(1.0f + u.y - r.x - f.z) * 2.0f;
+    out = quat((u.x + r.y) / s, 0.25f * s, (f.y + u.z) / s, (f.x - r.z) / s);
+  }
+  else
+  {
+    float s = std::sqrtf(1.0f + f.z - r.x - u.y) * 2.0f;
+    out = quat((f.x + r.z) / s, (f.y + u.z) / s, 0.25f * s, (r.y - u.x) / s);
+  }
+  // skewed input leaves it slightly off unit length
+  return normalized(out);
+}
+
+
+// **********************//
+//                       //
+// Fast trig approximations
+//                       //
+// **********************//
+
+// max absolute errors below were measured against libm over the
+// whole valid input range with bench/TrigReport.cpp (make trigreport)
+
+// odd taylor polynomial up to x^9 on [-pi/2, pi/2], inputs outside
+// that range are wrapped to [-pi, pi] then reflected into it
+// max error ~4e-6 for |x| < 2pi, grows slowly with |x| as the
+// range reduction loses precision
+// NOTE: on its own this is not much cheaper than a good libm sinf,
+// the wins are fastAcos and fastSlerp which skip trig altogether
+float fastSin(float x)
+{
+  const float PI = 3.14159265359f;
+  const float TWO_PI = 6.28318530718f;
+  const float HALF_PI = 1.57079632679f;
+
+  // round to the nearest whole turn with a cast, floor is a libm call
+  float turns = x * (1.0f / TWO_PI);
+  x = x - TWO_PI * (float) (int) (turns + (turns < 0.0f ? -0.5f : 0.5f));
+  if (x > HALF_PI)
+  {
+    x = PI - x;
+  }
+  else if (x < -HALF_PI)
+  {
+    x = -PI - x;
+  }
+  float x2 = x * x;
+  return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f
+    + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+// cos is sin shifted by a quarter turn, same max error as fastSin
+float fastCos(float x)
+{
+  return fastSin(x + 1.57079632679f);
+}
+
+// Abramowitz & Stegun 4.4.45: acos(x) = sqrt(1-x) * poly(x) on [0, 1]
+// negative inputs use acos(-x) = pi - acos(x)
+// inputs are clamped to [-1, 1], max error ~7e-5 radians
+// (so ~1.4e-4 for getAngle and quat powers, which double it)
+float fastAcos(float x)
+{
+  float a = std::fabsf(x);
+  if (a > 1.0f)
+  {
+    a = 1.0f;
+  }
+  float r = std::sqrtf(1.0f - a)
+    * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+  return x < 0.0f ? 3.14159265359f - r : r;
+}
+
+quat fastAngleAxis(float angle, const vec3& axis)
+{
+  vec3 norm = normalized(axis);
+  float s = fastSin(angle * 0.5f);
+  return quat(norm.x * s, norm.y * s, norm.z * s, fastCos(angle * 0.5f));
+}
+
+float fastGetAngle(const quat& q)
+{
+  return 2.0f * fastAcos(q.w);
+}
+
+quat fastPow(const quat& q, float f)
+{
+  float halfAngle = fastAcos(q.scalar) * f;
+  vec3 axis = normalized(q.vector);
+  float halfSin = fastSin(halfAngle);
+  return quat(
+      axis.x * halfSin
+    , axis.y * halfSin
+    , axis.z * halfSin
+    , fastCos(halfAngle)
+  );
+}
+
+// nlerp moves fastest in the middle of the arc, so t is first
+// remapped with a cubic that slows down the middle, then nlerp is
+// used as usual. the correction depends on how far apart the quats
+// are (their dot product); coefficients from Arseny Kapoulkine's
+// "Approximating slerp". no trig at all, max angular error against
+// slerp is ~8e-4 radians
+// assumes both quats in desired neighborhood
+quat fastSlerp(const quat& start, const quat& end, float t)
+{
+  float d = std::fabsf(dot(start, end));
+  float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+  float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+  float k = A * (t - 0.5f) * (t - 0.5f) + B;
+  float ot = t + t * (t - 0.5f) * (t - 1.0f) * k;
+  return nlerp(start, end, ot);
+}
+
 
-  up = cross(forward, right);
-  return lookRotation(forward, up);
+// **********************//
+//                       //
+//   Dual Quaternions    //
+//                       //
+// **********************//
+
+dualquat operator+(const dualquat& a, const dualquat& b)
+{
+  return dualquat(a.real + b.real, a.dual + b.dual);
+}
+
+dualquat operator*(const dualquat& dq, float f)
+{
+  return dualquat(dq.real * f, dq.dual * f);
+}
+
+// like quats, the left dual quat is applied first, then the right
+// both inputs are normalized so the result stays a rigid transform
+dualquat operator*(const dualquat& a, const dualquat& b)
+{
+  dualquat l = normalized(a);
+  dualquat r = normalized(b);
+  return dualquat(
+      l.real * r.real
+    , l.real * r.dual + l.dual * r.real
+  );
+}
+
+bool operator==(const dualquat& a, const dualquat& b)
+{
+  return a.real == b.real && a.dual == b.dual;
+}
+
+bool operator!=(const dualquat& a, const dualquat& b)
+{
+  return !(a == b);
+}
+
+// only the real part is needed to measure how similar two
+// dual quats are, the dual part holds translation
+float dot(const dualquat& a, const dualquat& b)
+{
+  return dot(a.real, b.real);
+}
+
+dualquat conjugate(const dualquat& dq)
+{
+  return dualquat(conjugate(dq.real), conjugate(dq.dual));
+}
+
+// a unit dual quat has a unit length real part, both parts
+// are divided by the length of the real part
+void normalize(dualquat& dq)
+{
+  float lenSq = dot(dq.real, dq.real);
+  if (lenSq < QUAT_EPSILON)
+  {
+    return;
+  }
+  float i_len = 1.0f / std::sqrtf(lenSq);
+  dq.real = dq.real * i_len;
+  dq.dual = dq.dual * i_len;
+}
+
+dualquat normalized(const dualquat& dq)
+{
+  float lenSq = dot(dq.real, dq.real);
+  if (lenSq < QUAT_EPSILON)
+  {
+    return dq;
+  }
+  float i_len = 1.0f / std::sqrtf(lenSq);
+  return dualquat(dq.real * i_len, dq.dual * i_len);
+}
+
+// the dual part is half the translation (as a pure quat)
+// multiplied by the rotation
+dualquat rotationTranslationToDualQuat(const quat& r, const vec3& t)
+{
+  quat d(t.x, t.y, t.z, 0.0f);
+  return dualquat(r, r * d * 0.5f);
+}
+
+// undo the above: translation = 2 * dual * conjugate(real)
+vec3 getTranslation(const dualquat& dq)
+{
+  quat d = conjugate(dq.real) * (dq.dual * 2.0f);
+  return vec3(d.x, d.y, d.z);
+}
+
+// vectors are only rotated, translation is ignored
+vec3 transformVector(const dualquat& dq, const vec3& v)
+{
+  return dq.real * v;
+}
+
+vec3 transformPoint(const dualquat& dq, const vec3& v)
+{
+  return dq.real * v + getTranslation(dq);
+}
+
+
+// **********************//
+//                       //
+//     Batch kernels     //
+//                       //
+// **********************//
+
+// normalize whole arrays at once. the SSE path works on 4 elements
+// per iteration with the reciprocal square root estimate (12 bits)
+// plus one Newton-Raphson step, which brings it to ~22 bits, close
+// to the 1.0f / sqrtf of the scalar functions
+// like normalize(v), anything with a squared length under epsilon
+// is left untouched
+
+#ifdef MATH_SSE
+// 1 / sqrt(lenSq) refined with r' = r * (1.5 - 0.5 * lenSq * r * r)
+// lanes where lenSq < epsilon get 1 so they are left unchanged
+static inline __m128 InvLen(__m128 lenSq, float epsilon)
+{
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 threeHalves = _mm_set1_ps(1.5f);
+  const __m128 one = _mm_set1_ps(1.0f);
+  __m128 r = _mm_rsqrt_ps(lenSq);
+  r = _mm_mul_ps(r, _mm_sub_ps(threeHalves,
+      _mm_mul_ps(_mm_mul_ps(half, lenSq), _mm_mul_ps(r, r))));
+  __m128 tooSmall = _mm_cmplt_ps(lenSq, _mm_set1_ps(epsilon));
+  return _mm_or_ps(_mm_and_ps(tooSmall, one), _mm_andnot_ps(tooSmall, r));
+}
+
+// squared length of 4 quats, one per lane
+static inline __m128 QuatLenSq(__m128 q0, __m128 q1, __m128 q2, __m128 q3)
+{
+  _MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(q0, q0), _mm_mul_ps(q1, q1)),
+                    _mm_add_ps(_mm_mul_ps(q2, q2), _mm_mul_ps(q3, q3)));
+}
+
+// scale each quat by its lane of inv and store
+static inline void QuatScaleStore(float* out, __m128 q0, __m128 q1,
+  __m128 q2, __m128 q3, __m128 inv)
+{
+  _mm_storeu_ps(out + 0, _mm_mul_ps(q0, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(0, 0, 0, 0))));
+  _mm_storeu_ps(out + 4, _mm_mul_ps(q1, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(1, 1, 1, 1))));
+  _mm_storeu_ps(out + 8, _mm_mul_ps(q2, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(2, 2, 2, 2))));
+  _mm_storeu_ps(out + 12, _mm_mul_ps(q3, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+#endif
+
+void normalize(quat* arr, unsigned int count)
+{
+  unsigned int i = 0;
+#ifdef MATH_SSE
+  for (; i + 4 <= count; i += 4)
+  {
+    float* q = arr[i].v;
+    __m128 q0 = _mm_loadu_ps(q + 0);
+    __m128 q1 = _mm_loadu_ps(q + 4);
+    __m128 q2 = _mm_loadu_ps(q + 8);
+    __m128 q3 = _mm_loadu_ps(q + 12);
+    __m128 inv = InvLen(QuatLenSq(q0, q1, q2, q3), QUAT_EPSILON);
+    QuatScaleStore(q, q0, q1, q2, q3, inv);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    normalize(arr[i]);
+  }
+}
+
+// blended and sampled quats are usually already (almost) unit length
+// groups where every quat is within epsilon of unit length are not
+// written back at all, which saves the store bandwidth
+void normalizeIfNeeded(quat* arr, unsigned int count, float epsilon)
+{
+  unsigned int i = 0;
+#ifdef MATH_SSE
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 eps = _mm_set1_ps(epsilon);
+  // |x| by clearing the sign bit
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  for (; i + 4 <= count; i += 4)
+  {
+    float* q = arr[i].v;
+    __m128 q0 = _mm_loadu_ps(q + 0);
+    __m128 q1 = _mm_loadu_ps(q + 4);
+    __m128 q2 = _mm_loadu_ps(q + 8);
+    __m128 q3 = _mm_loadu_ps(q + 12);
+    __m128 lenSq = QuatLenSq(q0, q1, q2, q3);
+    __m128 offBy = _mm_and_ps(_mm_sub_ps(lenSq, one), absMask);
+    if (_mm_movemask_ps(_mm_cmpgt_ps(offBy, eps)) == 0)
+    {
+      continue;
+    }
+    QuatScaleStore(q, q0, q1, q2, q3, InvLen(lenSq, QUAT_EPSILON));
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    if (std::fabsf(lenSq(arr[i]) - 1.0f) > epsilon)
+    {
+      normalize(arr[i]);
+    }
+  }
+}
+
+void normalize(vec3* arr, unsigned int count)
+{
+  unsigned int i = 0;
+#ifdef MATH_SSE
+  for (; i + 4 <= count; i += 4)
+  {
+    // 4 packed vec3s are 3 registers:
+    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+    float* v = arr[i].v;
+    __m128 a = _mm_loadu_ps(v + 0);
+    __m128 b = _mm_loadu_ps(v + 4);
+    __m128 c = _mm_loadu_ps(v + 8);
+
+    // shuffle into x0 x1 x2 x3, y0 y1 y2 y3, z0 z1 z2 z3
+    __m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    __m128 x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+    __m128 y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128 z0z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    __m128 z = _mm_shuffle_ps(z0z1, c, _MM_SHUFFLE(3, 0, 2, 0));
+
+    __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                              _mm_mul_ps(z, z));
+    __m128 inv = InvLen(lenSq, VEC_EPSILON);
+
+    // spread the inverse lengths back out to match a, b and c
+    __m128 i0 = _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(1, 0, 0, 0));
+    __m128 i1 = _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(2, 2, 1, 1));
+    __m128 i2 = _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(3, 3, 3, 2));
+    _mm_storeu_ps(v + 0, _mm_mul_ps(a, i0));
+    _mm_storeu_ps(v + 4, _mm_mul_ps(b, i1));
+    _mm_storeu_ps(v + 8, _mm_mul_ps(c, i2));
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    normalize(arr[i]);
+  }
 }
@@ -69,6 +69,26 @@ vec3 lerp(const vec3& a, const vec3& b, float t);
 vec3 slerp(const vec3& a, const vec3& b, float t);
 vec3 nlerp(const vec3& a, const vec3& b, float t);
 
+// storage variant of vec3 padded to 16 bytes and 16 byte aligned
+// arrays of vec3a can be read with aligned 128 bit loads, one vector
+// per register. convert to vec3 to do math with it
+struct alignas(16) vec3a
+{
+  union {
+    struct {
+      float x;
+      float y;
+      float z;
+      float pad;
+    };
+    float v[4];
+  };
+  inline vec3a() : x(0.0f), y(0.0f), z(0.0f), pad(0.0f) {}
+  inline vec3a(float _x, float _y, float _z):x(_x), y(_y), z(_z), pad(0.0f) {}
+  inline vec3a(const vec3& v3):x(v3.x), y(v3.y), z(v3.z), pad(0.0f) {}
+  inline operator vec3() const { return vec3(x, y, z); }
+};
+
 template<typename T>
 struct Tvec4
 {
@@ -101,7 +121,8 @@ typedef Tvec4<int> ivec4;
 // but represented as a linear array
 // thus mapping func is different: column * numberOfRows + row
 
-struct mat4
+// aligned to 16 bytes so each column can be loaded with one aligned load
+struct alignas(16) mat4
 {
   union {
     float v[16];
@@ -274,3 +295,62 @@ quat slerp(const quat& start, const quat& end, float t);
 quat lookRotation(const vec3& direction, const vec3& up);
 mat4 quatToMat4(const quat& q);
 quat mat4ToQuat(const mat4& m);
+
+// fast polynomial approximations of the trig used by quats, max
+// errors are documented in Math.cpp. call them directly, or build
+// with -DMATH_FAST_TRIG to make slerp, operator^, angle, angleAxis
+// and getAngle use them everywhere
+float fastSin(float x);
+float fastCos(float x);
+float fastAcos(float x);
+quat fastAngleAxis(float angle, const vec3& axis);
+float fastGetAngle(const quat& q);
+quat fastPow(const quat& q, float f);
+quat fastSlerp(const quat& start, const quat& end, float t);
+
+
+// **********************//
+//                       //
+//   Dual Quaternions    //
+//                       //
+// **********************//
+
+// a dual quaternion holds a rotation (real part) and a translation
+// (dual part) in 8 floats, half the size of a mat4
+// blending dual quaternions preserves volume around twisting joints,
+// so skinning with them avoids the candy-wrapper effect
+// NOTE: dual quaternions can't represent scale
+struct alignas(16) dualquat {
+  quat real;
+  quat dual;
+  inline dualquat() : real(0, 0, 0, 1), dual(0, 0, 0, 0) {}
+  inline dualquat(const quat& r, const quat& d) : real(r), dual(d) {}
+};
+
+dualquat operator+(const dualquat& a, const dualquat& b);
+dualquat operator*(const dualquat& dq, float f);
+dualquat operator*(const dualquat& a, const dualquat& b);
+bool operator==(const dualquat& a, const dualquat& b);
+bool operator!=(const dualquat& a, const dualquat& b);
+float dot(const dualquat& a, const dualquat& b);
+dualquat conjugate(const dualquat& dq);
+void normalize(dualquat& dq);
+dualquat normalized(const dualquat& dq);
+dualquat rotationTranslationToDualQuat(const quat& r, const vec3& t);
+vec3 getTranslation(const dualquat& dq);
+vec3 transformVector(const dualquat& dq, const vec3& v);
+vec3 transformPoint(const dualquat& dq, const vec3& v);
+
+
+// **********************//
+//                       //
+//     Batch kernels     //
+//                       //
+// **********************//
+
+// normalize every element of an array in place (SIMD where available)
+// normalizeIfNeeded skips quats whose squared length is already
+// within epsilon of 1
+void normalize(quat* arr, unsigned int count);
+void normalize(vec3* arr, unsigned int count);
+void normalizeIfNeeded(quat* arr, unsigned int count, float epsilon = QUAT_EPSILON);
@@ -0,0 +1,380 @@
+#include "Mesh.h"
+#include "Draw.h"
+#include "Transform.h"
+
+// GL buffers are created on the first upload, so meshes can be
+// built and processed without a GL context (offline tools)
+Mesh::Mesh()
+{
+  m_VertexCount = 0;
+  m_MaxInfluences = 4;
+  m_PosAttrib = 0;
+  m_NormAttrib = 0;
+  m_UvAttrib = 0;
+  m_WeightAttrib = 0;
+  m_InfluenceAttrib = 0;
+  m_IndexBuffer = 0;
+}
+
+// attributes own GL buffers and can't be copied, a copy gets its
+// own buffers filled from the CPU data
+Mesh::Mesh(const Mesh& other)
+{
+  m_VertexCount = 0;
+  m_MaxInfluences = 4;
+  m_PosAttrib = 0;
+  m_NormAttrib = 0;
+  m_UvAttrib = 0;
+  m_WeightAttrib = 0;
+  m_InfluenceAttrib = 0;
+  m_IndexBuffer = 0;
+  *this = other;
+}
+
+void Mesh::CreateOpenGLBuffers()
+{
+  if (m_PosAttrib != 0)
+  {
+    return;
+  }
+  m_PosAttrib = new Attribute<vec3>();
+  m_NormAttrib = new Attribute<vec3>();
+  m_UvAttrib = new Attribute<vec2>();
+  m_WeightAttrib = new Attribute<vec4>();
+  m_InfluenceAttrib = new Attribute<ivec4>();
+  m_IndexBuffer = new IndexBuffer();
+}
+
+Mesh& Mesh::operator=(const Mesh& other)
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+  m_Position = other.m_Position;
+  m_Normal = other.m_Normal;
+  m_TexCoord = other.m_TexCoord;
+  m_Weights = other.m_Weights;
+  m_Influences = other.m_Influences;
+  m_Indices = other.m_Indices;
+  m_VertexCount = other.m_VertexCount;
+  m_MaxInfluences = other.m_MaxInfluences;
+  m_MorphTargets = other.m_MorphTargets;
+  if (other.HasGPUData())
+  {
+    UpdateOpenGLBuffers();
+  }
+  return *this;
+}
+
+Mesh::~Mesh()
+{
+  delete m_PosAttrib;
+  delete m_NormAttrib;
+  delete m_UvAttrib;
+  delete m_WeightAttrib;
+  delete m_InfluenceAttrib;
+  delete m_IndexBuffer;
+}
+
+std::vector<vec3>& Mesh::GetPosition()
+{
+  return m_Position;
+}
+
+std::vector<vec3>& Mesh::GetNormal()
+{
+  return m_Normal;
+}
+
+std::vector<vec2>& Mesh::GetTexCoord()
+{
+  return m_TexCoord;
+}
+
+std::vector<vec4>& Mesh::GetWeights()
+{
+  return m_Weights;
+}
+
+std::vector<ivec4>& Mesh::GetInfluences()
+{
+  return m_Influences;
+}
+
+std::vector<unsigned int>& Mesh::GetIndices()
+{
+  return m_Indices;
+}
+
+std::vector<MorphTarget>& Mesh::GetMorphTargets()
+{
+  return m_MorphTargets;
+}
+
+unsigned int Mesh::GetVertexCount()
+{
+  return m_VertexCount;
+}
+
+unsigned int Mesh::GetMaxInfluences()
+{
+  return m_MaxInfluences;
+}
+
+void Mesh::SetMaxInfluences(unsigned int maxInfluences)
+{
+  m_MaxInfluences = maxInfluences;
+}
+
+void Mesh::UpdateOpenGLBuffers()
+{
+  CreateOpenGLBuffers();
+  if (m_Position.size() > 0)
+  {
+    m_VertexCount = (unsigned int) m_Position.size();
+    m_PosAttrib->Set(m_Position);
+  }
+  if (m_Normal.size() > 0)
+  {
+    m_NormAttrib->Set(m_Normal);
+  }
+  if (m_TexCoord.size() > 0)
+  {
+    m_UvAttrib->Set(m_TexCoord);
+  }
+  if (m_Weights.size() > 0)
+  {
+    m_WeightAttrib->Set(m_Weights);
+  }
+  if (m_Influences.size() > 0)
+  {
+    m_InfluenceAttrib->Set(m_Influences);
+  }
+  if (m_Indices.size() > 0)
+  {
+    m_IndexBuffer->Set(m_Indices);
+  }
+}
+
+// swap with empty vectors, clear() would keep the capacity
+void Mesh::ReleaseCPUData()
+{
+  std::vector<vec3>().swap(m_Position);
+  std::vector<vec3>().swap(m_Normal);
+  std::vector<vec2>().swap(m_TexCoord);
+  std::vector<vec4>().swap(m_Weights);
+  std::vector<ivec4>().swap(m_Influences);
+  std::vector<unsigned int>().swap(m_Indices);
+  std::vector<MorphTarget>().swap(m_MorphTargets);
+  std::vector<vec3>().swap(m_SkinnedPosition);
+  std::vector<vec3>().swap(m_SkinnedNormal);
+  std::vector<mat4>().swap(m_PosePalette);
+}
+
+bool Mesh::HasCPUData()
+{
+  return m_Position.size() > 0;
+}
+
+bool Mesh::HasGPUData() const
+{
+  return m_PosAttrib != 0;
+}
+
+// Attribute::Set only reads the arrays, glBufferData copies them
+void Mesh::UploadStreams(const vec3* position, const vec3* normal, const vec2* texCoord,
+  const vec4* weights, const ivec4* influences, unsigned int numVerts,
+  const unsigned int* indices, unsigned int numIndices)
+{
+  CreateOpenGLBuffers();
+  m_VertexCount = numVerts;
+  if (position != 0)
+  {
+    m_PosAttrib->Set((vec3*) position, numVerts);
+  }
+  if (normal != 0)
+  {
+    m_NormAttrib->Set((vec3*) normal, numVerts);
+  }
+  if (texCoord != 0)
+  {
+    m_UvAttrib->Set((vec2*) texCoord, numVerts);
+  }
+  if (weights != 0)
+  {
+    m_WeightAttrib->Set((vec4*) weights, numVerts);
+  }
+  if (influences != 0)
+  {
+    m_InfluenceAttrib->Set((ivec4*) influences, numVerts);
+  }
+  if (indices != 0 && numIndices > 0)
+  {
+    m_IndexBuffer->Set((unsigned int*) indices, numIndices);
+  }
+}
+
+// linear blend skinning with the pose palette times the inverse
+// bind pose, same as skinned.vert
+void Mesh::CPUSkin(Skeleton& skeleton, Pose& pose)
+{
+  unsigned int numVerts = (unsigned int) m_Position.size();
+  if (numVerts == 0)
+  {
+    return;
+  }
+  CreateOpenGLBuffers();
+  m_SkinnedPosition.resize(numVerts);
+  m_SkinnedNormal.resize(numVerts);
+
+  pose.GetMatrixPalette(m_PosePalette);
+  std::vector<mat4>& invBindPose = skeleton.GetInvBindPose();
+  for (unsigned int i = 0, size = (unsigned int) m_PosePalette.size(); i < size; ++i)
+  {
+    m_PosePalette[i] = m_PosePalette[i] * invBindPose[i];
+  }
+
+  bool hasNormals = m_Normal.size() == numVerts;
+  if (m_MaxInfluences == 1)
+  {
+    // rigid, influences are sorted so x is the only joint with weight 1
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      mat4& skin = m_PosePalette[m_Influences[i].x];
+      m_SkinnedPosition[i] = transformPoint(skin, m_Position[i]);
+      if (hasNormals)
+      {
+        m_SkinnedNormal[i] = transformVector(skin, m_Normal[i]);
+      }
+    }
+  }
+  else if (m_MaxInfluences == 2)
+  {
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      ivec4& joint = m_Influences[i];
+      vec4& weight = m_Weights[i];
+      mat4 skin = m_PosePalette[joint.x] * weight.x
+                + m_PosePalette[joint.y] * weight.y;
+      m_SkinnedPosition[i] = transformPoint(skin, m_Position[i]);
+      if (hasNormals)
+      {
+        m_SkinnedNormal[i] = transformVector(skin, m_Normal[i]);
+      }
+    }
+  }
+  else
+  {
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      ivec4& joint = m_Influences[i];
+      vec4& weight = m_Weights[i];
+
+      mat4 skin = m_PosePalette[joint.x] * weight.x
+                + m_PosePalette[joint.y] * weight.y
+                + m_PosePalette[joint.z] * weight.z
+                + m_PosePalette[joint.w] * weight.w;
+
+      m_SkinnedPosition[i] = transformPoint(skin, m_Position[i]);
+      if (hasNormals)
+      {
+        m_SkinnedNormal[i] = transformVector(skin, m_Normal[i]);
+      }
+    }
+  }
+
+  m_PosAttrib->Set(m_SkinnedPosition);
+  if (hasNormals)
+  {
+    m_NormAttrib->Set(m_SkinnedNormal);
+  }
+}
+
+void Mesh::Bind(int position, int normal, int texCoord, int weight, int influence)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (position >= 0)
+  {
+    m_PosAttrib->BindTo(position);
+  }
+  if (normal >= 0)
+  {
+    m_NormAttrib->BindTo(normal);
+  }
+  if (texCoord >= 0)
+  {
+    m_UvAttrib->BindTo(texCoord);
+  }
+  if (weight >= 0)
+  {
+    m_WeightAttrib->BindTo(weight);
+  }
+  if (influence >= 0)
+  {
+    m_InfluenceAttrib->BindTo(influence);
+  }
+}
+
+void Mesh::Draw()
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (m_IndexBuffer->Count() > 0)
+  {
+    ::Draw(*m_IndexBuffer, DrawMode::Triangles);
+  }
+  else
+  {
+    ::Draw(m_VertexCount, DrawMode::Triangles);
+  }
+}
+
+void Mesh::DrawInstanced(unsigned int numInstances)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (m_IndexBuffer->Count() > 0)
+  {
+    ::DrawInstanced(*m_IndexBuffer, DrawMode::Triangles, numInstances);
+  }
+  else
+  {
+    ::DrawInstanced(m_VertexCount, DrawMode::Triangles, numInstances);
+  }
+}
+
+void Mesh::UnBind(int position, int normal, int texCoord, int weight, int influence)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (position >= 0)
+  {
+    m_PosAttrib->UnBindFrom(position);
+  }
+  if (normal >= 0)
+  {
+    m_NormAttrib->UnBindFrom(normal);
+  }
+  if (texCoord >= 0)
+  {
+    m_UvAttrib->UnBindFrom(texCoord);
+  }
+  if (weight >= 0)
+  {
+    m_WeightAttrib->UnBindFrom(weight);
+  }
+  if (influence >= 0)
+  {
+    m_InfluenceAttrib->UnBindFrom(influence);
+  }
+}
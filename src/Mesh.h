@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Math.h"
+#include "Attribute.h"
+#include "IndexBuffer.h"
+#include "Skeleton.h"
+#include "Pose.h"
+#include "MorphTarget.h"
+#include <vector>
+
+class Mesh {
+  // a skinned mesh: the CPU copy of the vertex streams and the GPU
+  // buffers they are uploaded to. influences are joint indices in
+  // skeleton order, weights are the matching skin weights
+  // once uploaded the CPU copy can be released when the mesh is
+  // only skinned on the GPU, the GPU buffers stay valid
+  // GL buffers are only created on the first upload
+protected:
+  std::vector<vec3> m_Position;
+  std::vector<vec3> m_Normal;
+  std::vector<vec2> m_TexCoord;
+  std::vector<vec4> m_Weights;
+  std::vector<ivec4> m_Influences;
+  std::vector<unsigned int> m_Indices;
+  unsigned int m_VertexCount;
+  // most non zero weights on any vertex, see LimitInfluences
+  unsigned int m_MaxInfluences;
+  // sparse blend shapes, CPU only
+  std::vector<MorphTarget> m_MorphTargets;
+
+  Attribute<vec3>* m_PosAttrib;
+  Attribute<vec3>* m_NormAttrib;
+  Attribute<vec2>* m_UvAttrib;
+  Attribute<vec4>* m_WeightAttrib;
+  Attribute<ivec4>* m_InfluenceAttrib;
+  IndexBuffer* m_IndexBuffer;
+
+  // cpu skinning scratch
+  std::vector<vec3> m_SkinnedPosition;
+  std::vector<vec3> m_SkinnedNormal;
+  std::vector<mat4> m_PosePalette;
+
+protected:
+  void CreateOpenGLBuffers();
+
+public:
+  Mesh();
+  Mesh(const Mesh& other);
+  Mesh& operator=(const Mesh& other);
+  ~Mesh();
+
+  std::vector<vec3>& GetPosition();
+  std::vector<vec3>& GetNormal();
+  std::vector<vec2>& GetTexCoord();
+  std::vector<vec4>& GetWeights();
+  std::vector<ivec4>& GetInfluences();
+  std::vector<unsigned int>& GetIndices();
+  // deltas follow the vertices through the MeshOptimizer remaps
+  std::vector<MorphTarget>& GetMorphTargets();
+  unsigned int GetVertexCount();
+  // 1 = rigid, every vertex follows one joint. CPUSkin and shader
+  // selection can skip the blending for meshes under 4
+  unsigned int GetMaxInfluences();
+  void SetMaxInfluences(unsigned int maxInfluences);
+
+  // upload the CPU copy to the GPU buffers
+  void UpdateOpenGLBuffers();
+  // free the CPU copy, the GPU buffers and vertex count are kept
+  void ReleaseCPUData();
+  bool HasCPUData();
+  bool HasGPUData() const;
+  // upload streams that live outside the mesh (a mapped baked file)
+  // without making a CPU copy, null streams are skipped
+  void UploadStreams(const vec3* position, const vec3* normal, const vec2* texCoord,
+    const vec4* weights, const ivec4* influences, unsigned int numVerts,
+    const unsigned int* indices, unsigned int numIndices);
+  // skins the CPU copy and re-uploads positions and normals
+  void CPUSkin(Skeleton& skeleton, Pose& pose);
+
+  void Bind(int position, int normal, int texCoord, int weight, int influence);
+  void Draw();
+  void DrawInstanced(unsigned int numInstances);
+  void UnBind(int position, int normal, int texCoord, int weight, int influence);
+};
@@ -0,0 +1,149 @@
+#include "MeshLOD.h"
+#include "MeshSimplifier.h"
+#include <cmath>
+
+MeshLOD::MeshLOD()
+{
+  m_Radius = 0.0f;
+}
+
+void MeshLOD::Build(Mesh& source, unsigned int numLevels, float ratio, float maxError, float maxWeightDelta)
+{
+  m_Levels.clear();
+  m_Errors.clear();
+  m_Radius = 0.0f;
+  if (numLevels == 0 || !source.HasCPUData())
+  {
+    return;
+  }
+  // built in place, a Mesh copy re-uploads all of its buffers
+  m_Levels.reserve(numLevels);
+  m_Errors.reserve(numLevels);
+  m_Levels.push_back(Mesh());
+  Mesh& base = m_Levels[0];
+  base.GetPosition() = source.GetPosition();
+  base.GetNormal() = source.GetNormal();
+  base.GetTexCoord() = source.GetTexCoord();
+  base.GetWeights() = source.GetWeights();
+  base.GetInfluences() = source.GetInfluences();
+  base.GetIndices() = source.GetIndices();
+  base.SetMaxInfluences(source.GetMaxInfluences());
+  base.GetMorphTargets() = source.GetMorphTargets();
+  m_Errors.push_back(0.0f);
+
+  std::vector<vec3>& positions = base.GetPosition();
+  vec3 minimum = positions[0];
+  vec3 maximum = positions[0];
+  for (unsigned int i = 1, size = (unsigned int) positions.size(); i < size; ++i)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      minimum.v[c] = fminf(minimum.v[c], positions[i].v[c]);
+      maximum.v[c] = fmaxf(maximum.v[c], positions[i].v[c]);
+    }
+  }
+  vec3 center = (minimum + maximum) * 0.5f;
+  float extent = fmaxf(maximum.x - minimum.x, fmaxf(maximum.y - minimum.y, maximum.z - minimum.z));
+  for (unsigned int i = 0, size = (unsigned int) positions.size(); i < size; ++i)
+  {
+    m_Radius = fmaxf(m_Radius, len(positions[i] - center));
+  }
+
+  // every level is simplified from the source so its error is
+  // measured against the full detail mesh
+  float levelRatio = 1.0f;
+  unsigned int lastCount = (unsigned int) base.GetIndices().size();
+  for (unsigned int level = 1; level < numLevels; ++level)
+  {
+    levelRatio *= ratio;
+    float error = 0.0f;
+    Mesh simplified = SimplifyMesh(m_Levels[0], levelRatio, maxError, maxWeightDelta, &error);
+    unsigned int count = (unsigned int) simplified.GetIndices().size();
+    // less than 10% smaller than the last level isn't worth a level
+    if (count == 0 || count * 10 > lastCount * 9)
+    {
+      break;
+    }
+    lastCount = count;
+    m_Levels.push_back(Mesh());
+    Mesh& result = m_Levels.back();
+    result.GetPosition().swap(simplified.GetPosition());
+    result.GetNormal().swap(simplified.GetNormal());
+    result.GetTexCoord().swap(simplified.GetTexCoord());
+    result.GetWeights().swap(simplified.GetWeights());
+    result.GetInfluences().swap(simplified.GetInfluences());
+    result.GetIndices().swap(simplified.GetIndices());
+    result.SetMaxInfluences(simplified.GetMaxInfluences());
+    result.GetMorphTargets().swap(simplified.GetMorphTargets());
+    // relative error to mesh units
+    m_Errors.push_back(error * extent);
+  }
+}
+
+unsigned int MeshLOD::Size()
+{
+  return (unsigned int) m_Levels.size();
+}
+
+Mesh& MeshLOD::GetLevel(unsigned int level)
+{
+  return m_Levels[level];
+}
+
+float MeshLOD::GetError(unsigned int level)
+{
+  return m_Errors[level];
+}
+
+float MeshLOD::GetRadius()
+{
+  return m_Radius;
+}
+
+// errors only grow with the level, so the last level that fits wins
+unsigned int MeshLOD::SelectByScreenSize(float projectedRadius, float maxPixelError)
+{
+  if (m_Levels.size() == 0 || m_Radius <= 0.0f)
+  {
+    return 0;
+  }
+  float pixelsPerUnit = projectedRadius / m_Radius;
+  unsigned int result = 0;
+  for (unsigned int i = 1, size = (unsigned int) m_Levels.size(); i < size; ++i)
+  {
+    if (m_Errors[i] * pixelsPerUnit > maxPixelError)
+    {
+      break;
+    }
+    result = i;
+  }
+  return result;
+}
+
+unsigned int MeshLOD::SelectByDistance(float distance, float verticalFov, float screenHeight, float maxPixelError)
+{
+  if (distance <= m_Radius)
+  {
+    return 0;
+  }
+  // same projection as perspective(), pixels per unit at distance 1
+  float halfHeight = tanf(verticalFov * 3.14159265359f / 360.0f);
+  float projectedRadius = m_Radius / distance * (screenHeight * 0.5f) / halfHeight;
+  return SelectByScreenSize(projectedRadius, maxPixelError);
+}
+
+void MeshLOD::UpdateOpenGLBuffers()
+{
+  for (unsigned int i = 0, size = (unsigned int) m_Levels.size(); i < size; ++i)
+  {
+    m_Levels[i].UpdateOpenGLBuffers();
+  }
+}
+
+void MeshLOD::ReleaseCPUData()
+{
+  for (unsigned int i = 0, size = (unsigned int) m_Levels.size(); i < size; ++i)
+  {
+    m_Levels[i].ReleaseCPUData();
+  }
+}
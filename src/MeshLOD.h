@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+class MeshLOD {
+  // a chain of simplified copies of one skinned mesh, level 0 is the
+  // source. every level keeps the error it was simplified with, in
+  // mesh units, and selection picks the coarsest level whose error
+  // projects to at most maxPixelError pixels on screen
+  // levels share the skeleton and joint order of the source, any
+  // level can be skinned with the same pose palette
+protected:
+  std::vector<Mesh> m_Levels;
+  std::vector<float> m_Errors;
+  float m_Radius;
+
+public:
+  MeshLOD();
+  // levels at ratio, ratio^2, ... of the source triangles. stops early
+  // once a level can't get meaningfully smaller (locked seams, error
+  // limit). maxError is relative to the mesh size, see MeshSimplifier.h
+  void Build(Mesh& source, unsigned int numLevels = 4, float ratio = 0.5f,
+    float maxError = 0.05f, float maxWeightDelta = 0.5f);
+  unsigned int Size();
+  Mesh& GetLevel(unsigned int level);
+  float GetError(unsigned int level);
+  // bounding sphere radius around the bounds center, for screen size
+  float GetRadius();
+
+  // projectedRadius is the mesh's bounding sphere radius in pixels
+  unsigned int SelectByScreenSize(float projectedRadius, float maxPixelError = 1.0f);
+  // distance from the camera to the mesh, verticalFov in degrees like
+  // perspective(), screenHeight in pixels
+  unsigned int SelectByDistance(float distance, float verticalFov, float screenHeight,
+    float maxPixelError = 1.0f);
+
+  void UpdateOpenGLBuffers();
+  void ReleaseCPUData();
+};
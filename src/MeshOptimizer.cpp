@@ -0,0 +1,593 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+// **********************//
+//                       //
+//         Remap         //
+//                       //
+// **********************//
+
+template<typename T>
+static void RemapStream(std::vector<T>& stream, const std::vector<unsigned int>& remap, unsigned int newCount)
+{
+  if (stream.size() != remap.size())
+  {
+    return;
+  }
+  std::vector<T> result(newCount);
+  for (unsigned int i = 0, size = (unsigned int) remap.size(); i < size; ++i)
+  {
+    if (remap[i] != MESH_REMOVED)
+    {
+      result[remap[i]] = stream[i];
+    }
+  }
+  stream.swap(result);
+}
+
+static void RemapVertices(Mesh& mesh, const std::vector<unsigned int>& remap, unsigned int newCount)
+{
+  RemapStream(mesh.GetPosition(), remap, newCount);
+  RemapStream(mesh.GetNormal(), remap, newCount);
+  RemapStream(mesh.GetTexCoord(), remap, newCount);
+  RemapStream(mesh.GetWeights(), remap, newCount);
+  RemapStream(mesh.GetInfluences(), remap, newCount);
+  std::vector<MorphTarget>& targets = mesh.GetMorphTargets();
+  for (unsigned int i = 0, size = (unsigned int) targets.size(); i < size; ++i)
+  {
+    targets[i].Remap(remap, newCount);
+  }
+  std::vector<unsigned int>& indices = mesh.GetIndices();
+  for (unsigned int i = 0, size = (unsigned int) indices.size(); i < size; ++i)
+  {
+    indices[i] = remap[indices[i]];
+  }
+}
+
+// streams shorter than the position stream are ignored, the loader
+// only fills the ones that match the vertex count
+static bool IndicesValid(Mesh& mesh)
+{
+  unsigned int numVerts = (unsigned int) mesh.GetPosition().size();
+  std::vector<unsigned int>& indices = mesh.GetIndices();
+  for (unsigned int i = 0, size = (unsigned int) indices.size(); i < size; ++i)
+  {
+    if (indices[i] >= numVerts)
+    {
+      std::cout<<"Mesh index out of range, not optimizing\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// **********************//
+//                       //
+//       Influences      //
+//                       //
+// **********************//
+
+unsigned int LimitInfluences(Mesh& mesh, unsigned int maxInfluences)
+{
+  std::vector<vec4>& weights = mesh.GetWeights();
+  std::vector<ivec4>& influences = mesh.GetInfluences();
+  unsigned int numVerts = (unsigned int) weights.size();
+  if (numVerts == 0 || influences.size() != numVerts)
+  {
+    mesh.SetMaxInfluences(0);
+    return 0;
+  }
+  if (maxInfluences < 1)
+  {
+    maxInfluences = 1;
+  }
+  else if (maxInfluences > 4)
+  {
+    maxInfluences = 4;
+  }
+
+  unsigned int result = 0;
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    float w[4] = { weights[v].x, weights[v].y, weights[v].z, weights[v].w };
+    int j[4] = { influences[v].x, influences[v].y, influences[v].z, influences[v].w };
+    // insertion sort, biggest weight first
+    for (int i = 1; i < 4; ++i)
+    {
+      float key = w[i];
+      int joint = j[i];
+      int k = i - 1;
+      for (; k >= 0 && w[k] < key; --k)
+      {
+        w[k + 1] = w[k];
+        j[k + 1] = j[k];
+      }
+      w[k + 1] = key;
+      j[k + 1] = joint;
+    }
+
+    float sum = 0.0f;
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      if (i >= maxInfluences || w[i] <= 0.0f)
+      {
+        w[i] = 0.0f;
+        j[i] = 0;
+        continue;
+      }
+      sum += w[i];
+      ++count;
+    }
+    if (sum > 0.0f)
+    {
+      float invSum = 1.0f / sum;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+        w[i] *= invSum;
+      }
+    }
+    weights[v] = vec4(w[0], w[1], w[2], w[3]);
+    influences[v] = ivec4(j[0], j[1], j[2], j[3]);
+    if (count > result)
+    {
+      result = count;
+    }
+  }
+  mesh.SetMaxInfluences(result);
+  return result;
+}
+
+unsigned int CountMaxInfluences(const vec4* weights, unsigned int count)
+{
+  unsigned int result = 0;
+  for (unsigned int v = 0; v < count && result < 4; ++v)
+  {
+    unsigned int n = (weights[v].x > 0.0f) + (weights[v].y > 0.0f)
+      + (weights[v].z > 0.0f) + (weights[v].w > 0.0f);
+    if (n > result)
+    {
+      result = n;
+    }
+  }
+  return result;
+}
+
+// **********************//
+//                       //
+//          Weld         //
+//                       //
+// **********************//
+
+template<typename T>
+static void HashStream(uint64_t& hash, const std::vector<T>& stream, unsigned int vertex, unsigned int numVerts)
+{
+  if (stream.size() != numVerts)
+  {
+    return;
+  }
+  // every stream type is made of 4 byte components
+  const unsigned char* bytes = (const unsigned char*) &stream[vertex];
+  for (unsigned int i = 0; i < sizeof(T); i += 4)
+  {
+    uint32_t word;
+    memcpy(&word, bytes + i, 4);
+    hash = (hash ^ word) * 0x100000001B3ull;
+  }
+}
+
+template<typename T>
+static bool SameInStream(const std::vector<T>& stream, unsigned int a, unsigned int b, unsigned int numVerts)
+{
+  return stream.size() != numVerts || memcmp(&stream[a], &stream[b], sizeof(T)) == 0;
+}
+
+// one hash per vertex of every delta that moves it, 0 for vertices
+// no target touches. vertices only weld if these match too, two
+// vertices that only differ in a blend shape stay apart
+static std::vector<uint64_t> HashMorphTargets(Mesh& mesh, unsigned int numVerts)
+{
+  std::vector<MorphTarget>& targets = mesh.GetMorphTargets();
+  std::vector<uint64_t> result;
+  if (targets.size() == 0)
+  {
+    return result;
+  }
+  result.resize(numVerts, 0);
+  for (unsigned int t = 0, numTargets = (unsigned int) targets.size(); t < numTargets; ++t)
+  {
+    std::vector<MorphRun>& runs = targets[t].GetRuns();
+    std::vector<vec3>& positions = targets[t].GetPositionDeltas();
+    std::vector<vec3>& normals = targets[t].GetNormalDeltas();
+    unsigned int delta = 0;
+    for (unsigned int r = 0, numRuns = (unsigned int) runs.size(); r < numRuns; ++r)
+    {
+      for (unsigned int i = 0; i < runs[r].count; ++i, ++delta)
+      {
+        unsigned int vertex = runs[r].start + i;
+        if (vertex >= numVerts)
+        {
+          continue;
+        }
+        uint64_t hash = result[vertex] ^ ((t + 1) * 0x9E3779B97F4A7C15ull);
+        HashStream(hash, positions, delta, (unsigned int) positions.size());
+        if (normals.size() > 0)
+        {
+          HashStream(hash, normals, delta, (unsigned int) normals.size());
+        }
+        result[vertex] = hash | 1;
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<unsigned int> WeldVertices(Mesh& mesh)
+{
+  unsigned int numVerts = (unsigned int) mesh.GetPosition().size();
+  std::vector<unsigned int>& indices = mesh.GetIndices();
+  std::vector<unsigned int> remap(numVerts, MESH_REMOVED);
+  if (numVerts == 0)
+  {
+    return remap;
+  }
+  if (indices.size() == 0)
+  {
+    indices.resize(numVerts);
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      indices[i] = i;
+    }
+  }
+  else if (!IndicesValid(mesh))
+  {
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      remap[i] = i;
+    }
+    return remap;
+  }
+
+  std::vector<vec3>& position = mesh.GetPosition();
+  std::vector<vec3>& normal = mesh.GetNormal();
+  std::vector<vec2>& texCoord = mesh.GetTexCoord();
+  std::vector<vec4>& weights = mesh.GetWeights();
+  std::vector<ivec4>& influences = mesh.GetInfluences();
+  std::vector<uint64_t> morphs = HashMorphTargets(mesh, numVerts);
+
+  // open addressing, table at least twice the vertex count. slots
+  // hold the first vertex seen with that content
+  unsigned int tableSize = 1;
+  while (tableSize < numVerts * 2)
+  {
+    tableSize <<= 1;
+  }
+  std::vector<unsigned int> table(tableSize, MESH_REMOVED);
+  unsigned int newCount = 0;
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    HashStream(hash, position, v, numVerts);
+    HashStream(hash, normal, v, numVerts);
+    HashStream(hash, texCoord, v, numVerts);
+    HashStream(hash, weights, v, numVerts);
+    HashStream(hash, influences, v, numVerts);
+    HashStream(hash, morphs, v, numVerts);
+    unsigned int slot = (unsigned int) (hash ^ (hash >> 32)) & (tableSize - 1);
+    for (;;)
+    {
+      unsigned int other = table[slot];
+      if (other == MESH_REMOVED)
+      {
+        table[slot] = v;
+        remap[v] = newCount++;
+        break;
+      }
+      if (SameInStream(position, v, other, numVerts) && SameInStream(normal, v, other, numVerts)
+        && SameInStream(texCoord, v, other, numVerts) && SameInStream(weights, v, other, numVerts)
+        && SameInStream(influences, v, other, numVerts) && SameInStream(morphs, v, other, numVerts))
+      {
+        remap[v] = remap[other];
+        break;
+      }
+      slot = (slot + 1) & (tableSize - 1);
+    }
+  }
+  if (newCount < numVerts)
+  {
+    RemapVertices(mesh, remap, newCount);
+  }
+  return remap;
+}
+
+// **********************//
+//                       //
+//     Vertex cache      //
+//                       //
+// **********************//
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation". a vertex
+// scores higher the more recently it was used and the fewer triangles
+// it has left, the highest scoring triangle goes next
+#define VCACHE_SIZE 32
+#define VCACHE_MAX_VALENCE 32
+
+struct VertexScoreTables
+{
+  float cache[VCACHE_SIZE];
+  float valence[VCACHE_MAX_VALENCE + 1];
+
+  VertexScoreTables()
+  {
+    for (int i = 0; i < VCACHE_SIZE; ++i)
+    {
+      // the last triangle's vertices get a fixed score so the
+      // next triangle doesn't just reuse the same edge
+      cache[i] = i < 3 ? 0.75f : powf(1.0f - (float) (i - 3) / (float) (VCACHE_SIZE - 3), 1.5f);
+    }
+    valence[0] = 0.0f;
+    for (int i = 1; i <= VCACHE_MAX_VALENCE; ++i)
+    {
+      valence[i] = 2.0f / sqrtf((float) i);
+    }
+  }
+};
+
+// function local so worker threads importing at once init it safely
+static const VertexScoreTables& GetScoreTables()
+{
+  static VertexScoreTables tables;
+  return tables;
+}
+
+static float VertexScore(const VertexScoreTables& tables, int cachePosition, unsigned int valence)
+{
+  if (valence == 0)
+  {
+    return -1.0f;
+  }
+  float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+  return score + tables.valence[valence < VCACHE_MAX_VALENCE ? valence : VCACHE_MAX_VALENCE];
+}
+
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int numVerts)
+{
+  unsigned int numTris = (unsigned int) indices.size() / 3;
+  if (numTris == 0 || indices.size() % 3 != 0)
+  {
+    return;
+  }
+  for (unsigned int i = 0, size = (unsigned int) indices.size(); i < size; ++i)
+  {
+    if (indices[i] >= numVerts)
+    {
+      std::cout<<"Mesh index out of range, not optimizing\n";
+      return;
+    }
+  }
+  const VertexScoreTables& tables = GetScoreTables();
+
+  // triangles using each vertex, packed. live[v] is how many of them
+  // are not emitted yet, those are kept at the front of the range
+  std::vector<unsigned int> offsets(numVerts + 1, 0);
+  for (unsigned int i = 0; i < numTris * 3; ++i)
+  {
+    ++offsets[indices[i] + 1];
+  }
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<unsigned int> adjacency(numTris * 3);
+  std::vector<unsigned int> live(numVerts, 0);
+  for (unsigned int t = 0; t < numTris; ++t)
+  {
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+      unsigned int v = indices[t * 3 + c];
+      adjacency[offsets[v] + live[v]++] = t;
+    }
+  }
+
+  std::vector<int> cachePosition(numVerts, -1);
+  std::vector<float> vertexScores(numVerts);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    vertexScores[v] = VertexScore(tables, -1, live[v]);
+  }
+  std::vector<float> triangleScores(numTris);
+  std::vector<bool> emitted(numTris, false);
+  unsigned int bestTriangle = 0;
+  for (unsigned int t = 0; t < numTris; ++t)
+  {
+    const unsigned int* tri = &indices[t * 3];
+    triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+    if (triangleScores[t] > triangleScores[bestTriangle])
+    {
+      bestTriangle = t;
+    }
+  }
+
+  std::vector<unsigned int> result(numTris * 3);
+  unsigned int cache[VCACHE_SIZE + 3];
+  unsigned int cacheCount = 0;
+  unsigned int newCache[VCACHE_SIZE + 3];
+  unsigned int cursor = 0;
+
+  for (unsigned int out = 0; out < numTris; ++out)
+  {
+    if (bestTriangle == MESH_REMOVED)
+    {
+      // nothing in the cache touches a live triangle, take the next
+      // one in input order
+      while (emitted[cursor])
+      {
+        ++cursor;
+      }
+      bestTriangle = cursor;
+    }
+    unsigned int tri[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+    result[out * 3] = tri[0];
+    result[out * 3 + 1] = tri[1];
+    result[out * 3 + 2] = tri[2];
+    emitted[bestTriangle] = true;
+
+    // move the triangle past each vertex's live range
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+      unsigned int v = tri[c];
+      unsigned int* begin = &adjacency[offsets[v]];
+      for (unsigned int i = 0; i < live[v]; ++i)
+      {
+        if (begin[i] == bestTriangle)
+        {
+          begin[i] = begin[live[v] - 1];
+          begin[live[v] - 1] = bestTriangle;
+          --live[v];
+          break;
+        }
+      }
+    }
+
+    // the triangle's vertices go to the front, the rest shift back
+    unsigned int newCount = 0;
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+      // degenerate triangles repeat a vertex
+      if (c == 0 || (tri[c] != tri[0] && (c == 1 || tri[c] != tri[1])))
+      {
+        newCache[newCount++] = tri[c];
+      }
+    }
+    for (unsigned int i = 0; i < cacheCount; ++i)
+    {
+      unsigned int v = cache[i];
+      if (v != tri[0] && v != tri[1] && v != tri[2])
+      {
+        newCache[newCount++] = v;
+      }
+    }
+
+    // rescore every vertex that moved, and the live triangles
+    // around them. the best of those is the next candidate
+    bestTriangle = MESH_REMOVED;
+    float bestScore = -1.0f;
+    for (unsigned int i = 0; i < newCount; ++i)
+    {
+      unsigned int v = newCache[i];
+      cachePosition[v] = i < VCACHE_SIZE ? (int) i : -1;
+      vertexScores[v] = VertexScore(tables, cachePosition[v], live[v]);
+    }
+    for (unsigned int i = 0; i < newCount; ++i)
+    {
+      unsigned int v = newCache[i];
+      const unsigned int* begin = &adjacency[offsets[v]];
+      for (unsigned int j = 0; j < live[v]; ++j)
+      {
+        unsigned int t = begin[j];
+        const unsigned int* other = &indices[t * 3];
+        float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+        triangleScores[t] = score;
+        if (score > bestScore)
+        {
+          bestScore = score;
+          bestTriangle = t;
+        }
+      }
+    }
+
+    cacheCount = newCount < VCACHE_SIZE ? newCount : VCACHE_SIZE;
+    memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+  }
+  indices.swap(result);
+}
+
+// **********************//
+//                       //
+//      Vertex fetch     //
+//                       //
+// **********************//
+
+std::vector<unsigned int> OptimizeVertexFetch(Mesh& mesh)
+{
+  unsigned int numVerts = (unsigned int) mesh.GetPosition().size();
+  std::vector<unsigned int> remap(numVerts, MESH_REMOVED);
+  std::vector<unsigned int>& indices = mesh.GetIndices();
+  if (indices.size() == 0 || !IndicesValid(mesh))
+  {
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      remap[i] = i;
+    }
+    return remap;
+  }
+  unsigned int newCount = 0;
+  for (unsigned int i = 0, size = (unsigned int) indices.size(); i < size; ++i)
+  {
+    if (remap[indices[i]] == MESH_REMOVED)
+    {
+      remap[indices[i]] = newCount++;
+    }
+  }
+  RemapVertices(mesh, remap, newCount);
+  return remap;
+}
+
+std::vector<unsigned int> OptimizeMesh(Mesh& mesh)
+{
+  if (!IndicesValid(mesh))
+  {
+    unsigned int numVerts = (unsigned int) mesh.GetPosition().size();
+    std::vector<unsigned int> remap(numVerts);
+    for (unsigned int i = 0; i < numVerts; ++i)
+    {
+      remap[i] = i;
+    }
+    return remap;
+  }
+  std::vector<unsigned int> remap = WeldVertices(mesh);
+  OptimizeVertexCache(mesh.GetIndices(), (unsigned int) mesh.GetPosition().size());
+  std::vector<unsigned int> fetch = OptimizeVertexFetch(mesh);
+  for (unsigned int i = 0, size = (unsigned int) remap.size(); i < size; ++i)
+  {
+    if (remap[i] != MESH_REMOVED)
+    {
+      remap[i] = fetch[remap[i]];
+    }
+  }
+  return remap;
+}
+
+float GetCacheMissRatio(const std::vector<unsigned int>& indices, unsigned int cacheSize)
+{
+  unsigned int numTris = (unsigned int) indices.size() / 3;
+  if (numTris == 0 || cacheSize == 0)
+  {
+    return 0.0f;
+  }
+  std::vector<unsigned int> fifo(cacheSize, MESH_REMOVED);
+  unsigned int head = 0;
+  unsigned int misses = 0;
+  for (unsigned int i = 0; i < numTris * 3; ++i)
+  {
+    bool hit = false;
+    for (unsigned int j = 0; j < cacheSize; ++j)
+    {
+      if (fifo[j] == indices[i])
+      {
+        hit = true;
+        break;
+      }
+    }
+    if (!hit)
+    {
+      fifo[head] = indices[i];
+      head = (head + 1) % cacheSize;
+      ++misses;
+    }
+  }
+  return (float) misses / (float) numTris;
+}
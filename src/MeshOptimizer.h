@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+// import time mesh processing, all on the CPU copy before upload
+// every function that moves vertices returns a remap table, old
+// vertex index -> new vertex index (MESH_REMOVED if dropped), so
+// anything else indexed by vertex can follow along
+
+#define MESH_REMOVED 0xFFFFFFFFu
+
+// keeps the maxInfluences (1 to 4) biggest weights of each vertex,
+// sorted biggest first and renormalized to add up to 1. dropped slots
+// get joint 0 and weight 0. returns the most influences any vertex
+// still has, which is also stored with SetMaxInfluences
+unsigned int LimitInfluences(Mesh& mesh, unsigned int maxInfluences = 4);
+// most non zero weights on any vertex
+unsigned int CountMaxInfluences(const vec4* weights, unsigned int count);
+
+// merges vertices that are identical in every stream and every morph
+// target delta, non indexed meshes get an index buffer
+std::vector<unsigned int> WeldVertices(Mesh& mesh);
+// reorders triangles so the post transform vertex cache hits more
+// often (Forsyth's linear speed algorithm), vertices don't move
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int numVerts);
+// renumbers vertices in the order the index buffer first uses them so
+// fetches walk memory forward, unreferenced vertices are dropped
+std::vector<unsigned int> OptimizeVertexFetch(Mesh& mesh);
+// all three in order, returns the combined remap
+std::vector<unsigned int> OptimizeMesh(Mesh& mesh);
+
+// average transformed vertices per triangle with a FIFO cache of
+// cacheSize entries, 0.5 is the best possible on big meshes, 3 the worst
+float GetCacheMissRatio(const std::vector<unsigned int>& indices, unsigned int cacheSize = 32);
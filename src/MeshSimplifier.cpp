@@ -0,0 +1,502 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+// **********************//
+//                       //
+//        Quadrics       //
+//                       //
+// **********************//
+
+// sum of squared distances to a set of planes, area weighted. a
+// symmetric 3x3 matrix, a vector and a constant. doubles, the sums
+// get large on big meshes
+struct Quadric
+{
+  double a00, a01, a02, a11, a12, a22;
+  double b0, b1, b2;
+  double c;
+  double weight;
+};
+
+static void ClearQuadric(Quadric& q)
+{
+  memset(&q, 0, sizeof(Quadric));
+}
+
+static void AddPlane(Quadric& q, double nx, double ny, double nz, double d, double weight)
+{
+  q.a00 += weight * nx * nx;
+  q.a01 += weight * nx * ny;
+  q.a02 += weight * nx * nz;
+  q.a11 += weight * ny * ny;
+  q.a12 += weight * ny * nz;
+  q.a22 += weight * nz * nz;
+  q.b0 += weight * nx * d;
+  q.b1 += weight * ny * d;
+  q.b2 += weight * nz * d;
+  q.c += weight * d * d;
+  q.weight += weight;
+}
+
+static void AddQuadric(Quadric& q, const Quadric& other)
+{
+  q.a00 += other.a00;
+  q.a01 += other.a01;
+  q.a02 += other.a02;
+  q.a11 += other.a11;
+  q.a12 += other.a12;
+  q.a22 += other.a22;
+  q.b0 += other.b0;
+  q.b1 += other.b1;
+  q.b2 += other.b2;
+  q.c += other.c;
+  q.weight += other.weight;
+}
+
+// average squared distance from p to the planes of a and b
+static double QuadricError(const Quadric& a, const Quadric& b, const vec3& p)
+{
+  double x = p.x, y = p.y, z = p.z;
+  double a00 = a.a00 + b.a00, a01 = a.a01 + b.a01, a02 = a.a02 + b.a02;
+  double a11 = a.a11 + b.a11, a12 = a.a12 + b.a12, a22 = a.a22 + b.a22;
+  double error = a00 * x * x + a11 * y * y + a22 * z * z
+    + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+    + 2.0 * ((a.b0 + b.b0) * x + (a.b1 + b.b1) * y + (a.b2 + b.b2) * z)
+    + a.c + b.c;
+  double weight = a.weight + b.weight;
+  return weight > 0.0 ? fabs(error) / weight : 0.0;
+}
+
+// **********************//
+//                       //
+//        Helpers        //
+//                       //
+// **********************//
+
+// vertices that share a position get the same position id, the id is
+// the first such vertex
+static void BuildPositionIds(const std::vector<vec3>& positions, std::vector<unsigned int>& ids)
+{
+  unsigned int numVerts = (unsigned int) positions.size();
+  ids.resize(numVerts);
+  unsigned int tableSize = 1;
+  while (tableSize < numVerts * 2)
+  {
+    tableSize <<= 1;
+  }
+  std::vector<unsigned int> table(tableSize, MESH_REMOVED);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    uint32_t words[3];
+    memcpy(words, &positions[v], sizeof(words));
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (int i = 0; i < 3; ++i)
+    {
+      hash = (hash ^ words[i]) * 0x100000001B3ull;
+    }
+    unsigned int slot = (unsigned int) (hash ^ (hash >> 32)) & (tableSize - 1);
+    for (;;)
+    {
+      unsigned int other = table[slot];
+      if (other == MESH_REMOVED)
+      {
+        table[slot] = v;
+        ids[v] = v;
+        break;
+      }
+      if (memcmp(&positions[other], &positions[v], sizeof(vec3)) == 0)
+      {
+        ids[v] = other;
+        break;
+      }
+      slot = (slot + 1) & (tableSize - 1);
+    }
+  }
+}
+
+static uint64_t EdgeKey(unsigned int a, unsigned int b)
+{
+  return a < b ? ((uint64_t) a << 32) | b : ((uint64_t) b << 32) | a;
+}
+
+// sum over joints of the weight difference, 0 = same influences,
+// 2 = nothing in common
+static float WeightDelta(const vec4& wa, const ivec4& ja, const vec4& wb, const ivec4& jb)
+{
+  float delta = 0.0f;
+  for (int i = 0; i < 4; ++i)
+  {
+    if (wa.v[i] <= 0.0f)
+    {
+      continue;
+    }
+    float other = 0.0f;
+    for (int k = 0; k < 4; ++k)
+    {
+      if (jb.v[k] == ja.v[i])
+      {
+        other += wb.v[k];
+      }
+    }
+    delta += fabsf(wa.v[i] - other);
+  }
+  for (int k = 0; k < 4; ++k)
+  {
+    if (wb.v[k] <= 0.0f)
+    {
+      continue;
+    }
+    bool shared = false;
+    for (int i = 0; i < 4; ++i)
+    {
+      if (ja.v[i] == jb.v[k] && wa.v[i] > 0.0f)
+      {
+        shared = true;
+      }
+    }
+    if (!shared)
+    {
+      delta += wb.v[k];
+    }
+  }
+  return delta;
+}
+
+static vec3 TriangleNormal(const vec3& a, const vec3& b, const vec3& c)
+{
+  vec3 e0 = b - a;
+  vec3 e1 = c - a;
+  return vec3(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+}
+
+struct Collapse
+{
+  unsigned int from;
+  unsigned int to;
+  float cost;
+};
+
+static bool CollapseLess(const Collapse& a, const Collapse& b)
+{
+  return a.cost < b.cost;
+}
+
+// **********************//
+//                       //
+//        Simplify       //
+//                       //
+// **********************//
+
+std::vector<unsigned int> SimplifyIndices(Mesh& mesh, unsigned int targetIndexCount,
+  float maxError, float maxWeightDelta, float* outError)
+{
+  std::vector<vec3>& positions = mesh.GetPosition();
+  std::vector<unsigned int> result = mesh.GetIndices();
+  unsigned int numVerts = (unsigned int) positions.size();
+  if (outError != 0)
+  {
+    *outError = 0.0f;
+  }
+  if (numVerts == 0 || result.size() % 3 != 0 || result.size() <= targetIndexCount)
+  {
+    return result;
+  }
+  for (unsigned int i = 0, size = (unsigned int) result.size(); i < size; ++i)
+  {
+    if (result[i] >= numVerts)
+    {
+      return result;
+    }
+  }
+
+  std::vector<vec4>& weights = mesh.GetWeights();
+  std::vector<ivec4>& influences = mesh.GetInfluences();
+  bool skinned = weights.size() == numVerts && influences.size() == numVerts;
+
+  std::vector<unsigned int> positionIds;
+  BuildPositionIds(positions, positionIds);
+
+  // seams: a position used by more than one vertex
+  std::vector<unsigned int> wedges(numVerts, 0);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    ++wedges[positionIds[v]];
+  }
+  std::vector<bool> locked(numVerts, false);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    locked[v] = wedges[positionIds[v]] > 1;
+  }
+  // borders and non manifold edges: a position edge not used by
+  // exactly two triangles
+  std::unordered_map<uint64_t, unsigned int> edgeUse;
+  edgeUse.reserve(result.size());
+  for (unsigned int i = 0, size = (unsigned int) result.size(); i < size; i += 3)
+  {
+    for (int e = 0; e < 3; ++e)
+    {
+      unsigned int a = positionIds[result[i + e]];
+      unsigned int b = positionIds[result[i + (e + 1) % 3]];
+      ++edgeUse[EdgeKey(a, b)];
+    }
+  }
+  for (unsigned int i = 0, size = (unsigned int) result.size(); i < size; i += 3)
+  {
+    for (int e = 0; e < 3; ++e)
+    {
+      unsigned int a = result[i + e];
+      unsigned int b = result[i + (e + 1) % 3];
+      if (edgeUse[EdgeKey(positionIds[a], positionIds[b])] != 2)
+      {
+        locked[a] = true;
+        locked[b] = true;
+      }
+    }
+  }
+  // locks are per position, every wedge of a locked position is locked
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    if (locked[v])
+    {
+      locked[positionIds[v]] = true;
+    }
+  }
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    locked[v] = locked[positionIds[v]];
+  }
+
+  // extent for the relative error
+  vec3 minimum = positions[0];
+  vec3 maximum = positions[0];
+  for (unsigned int v = 1; v < numVerts; ++v)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      minimum.v[c] = fminf(minimum.v[c], positions[v].v[c]);
+      maximum.v[c] = fmaxf(maximum.v[c], positions[v].v[c]);
+    }
+  }
+  float extent = fmaxf(maximum.x - minimum.x, fmaxf(maximum.y - minimum.y, maximum.z - minimum.z));
+  if (extent <= 0.0f)
+  {
+    return result;
+  }
+  double maxErrorSq = (double) maxError * extent * (double) maxError * extent;
+
+  // one quadric per position, from the planes of its triangles
+  std::vector<Quadric> quadrics(numVerts);
+  for (unsigned int v = 0; v < numVerts; ++v)
+  {
+    ClearQuadric(quadrics[v]);
+  }
+  for (unsigned int i = 0, size = (unsigned int) result.size(); i < size; i += 3)
+  {
+    const vec3& a = positions[result[i]];
+    vec3 n = TriangleNormal(a, positions[result[i + 1]], positions[result[i + 2]]);
+    double length = sqrt((double) n.x * n.x + (double) n.y * n.y + (double) n.z * n.z);
+    if (length == 0.0)
+    {
+      continue;
+    }
+    double nx = n.x / length, ny = n.y / length, nz = n.z / length;
+    double d = -(nx * a.x + ny * a.y + nz * a.z);
+    // length is twice the area
+    double area = length * 0.5;
+    for (int c = 0; c < 3; ++c)
+    {
+      AddPlane(quadrics[positionIds[result[i + c]]], nx, ny, nz, d, area);
+    }
+  }
+
+  std::vector<Collapse> collapses;
+  std::vector<unsigned int> remap(numVerts);
+  std::vector<bool> touched(numVerts);
+  std::vector<unsigned int> offsets(numVerts + 1);
+  std::vector<unsigned int> adjacency;
+  double reached = 0.0;
+
+  // passes of non overlapping collapses, cheapest first, until the
+  // target or the error limit is hit
+  while (result.size() > targetIndexCount)
+  {
+    unsigned int numIndices = (unsigned int) result.size();
+
+    // triangles around each vertex, for the flip test
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (unsigned int i = 0; i < numIndices; ++i)
+    {
+      ++offsets[result[i] + 1];
+    }
+    for (unsigned int v = 0; v < numVerts; ++v)
+    {
+      offsets[v + 1] += offsets[v];
+    }
+    adjacency.resize(numIndices);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < numIndices; ++i)
+    {
+      adjacency[fill[result[i]]++] = i / 3;
+    }
+
+    collapses.clear();
+    for (unsigned int i = 0; i < numIndices; i += 3)
+    {
+      for (int e = 0; e < 3; ++e)
+      {
+        unsigned int a = result[i + e];
+        unsigned int b = result[i + (e + 1) % 3];
+        // every interior edge is seen from both triangles, take it
+        // from one so each direction is costed once
+        if (a > b)
+        {
+          continue;
+        }
+        for (int direction = 0; direction < 2; ++direction)
+        {
+          unsigned int from = direction == 0 ? a : b;
+          unsigned int to = direction == 0 ? b : a;
+          if (locked[from] || positionIds[from] == positionIds[to])
+          {
+            continue;
+          }
+          if (skinned && WeightDelta(weights[from], influences[from], weights[to], influences[to]) > maxWeightDelta)
+          {
+            continue;
+          }
+          Collapse collapse;
+          collapse.from = from;
+          collapse.to = to;
+          collapse.cost = (float) QuadricError(quadrics[positionIds[from]], quadrics[positionIds[to]], positions[to]);
+          collapses.push_back(collapse);
+        }
+      }
+    }
+    if (collapses.empty())
+    {
+      break;
+    }
+    std::sort(collapses.begin(), collapses.end(), CollapseLess);
+
+    for (unsigned int v = 0; v < numVerts; ++v)
+    {
+      remap[v] = v;
+    }
+    std::fill(touched.begin(), touched.end(), false);
+    // each collapse takes about two triangles
+    unsigned int trianglesToGo = (numIndices - targetIndexCount) / 3;
+    unsigned int removed = 0;
+    unsigned int numCollapsed = 0;
+    for (unsigned int c = 0, size = (unsigned int) collapses.size(); c < size && removed < trianglesToGo; ++c)
+    {
+      const Collapse& collapse = collapses[c];
+      if (collapse.cost > maxErrorSq)
+      {
+        break;
+      }
+      unsigned int from = collapse.from;
+      unsigned int to = collapse.to;
+      if (touched[from] || touched[to])
+      {
+        continue;
+      }
+
+      // reject if any remaining triangle around from flips or
+      // degenerates once from moves to to
+      bool valid = true;
+      unsigned int lost = 0;
+      for (unsigned int k = offsets[from]; k < offsets[from + 1] && valid; ++k)
+      {
+        const unsigned int* tri = &result[adjacency[k] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to)
+        {
+          ++lost;
+          continue;
+        }
+        vec3 p[3];
+        vec3 q[3];
+        for (int i = 0; i < 3; ++i)
+        {
+          p[i] = positions[tri[i]];
+          q[i] = tri[i] == from ? positions[to] : p[i];
+        }
+        vec3 before = TriangleNormal(p[0], p[1], p[2]);
+        vec3 after = TriangleNormal(q[0], q[1], q[2]);
+        float d = before.x * after.x + before.y * after.y + before.z * after.z;
+        float lengths = sqrtf(lenSqr(before) * lenSqr(after));
+        if (d <= 0.2f * lengths)
+        {
+          valid = false;
+        }
+      }
+      if (!valid)
+      {
+        continue;
+      }
+
+      remap[from] = to;
+      AddQuadric(quadrics[positionIds[to]], quadrics[positionIds[from]]);
+      reached = reached > collapse.cost ? reached : collapse.cost;
+      removed += lost > 0 ? lost : 1;
+      ++numCollapsed;
+      // the whole one ring of from is off limits for this pass, the
+      // flip test above assumed none of it moves
+      for (unsigned int k = offsets[from]; k < offsets[from + 1]; ++k)
+      {
+        const unsigned int* tri = &result[adjacency[k] * 3];
+        touched[tri[0]] = true;
+        touched[tri[1]] = true;
+        touched[tri[2]] = true;
+      }
+    }
+    if (numCollapsed == 0)
+    {
+      break;
+    }
+
+    unsigned int write = 0;
+    for (unsigned int i = 0; i < numIndices; i += 3)
+    {
+      unsigned int a = remap[result[i]];
+      unsigned int b = remap[result[i + 1]];
+      unsigned int c = remap[result[i + 2]];
+      if (positionIds[a] == positionIds[b] || positionIds[b] == positionIds[c] || positionIds[a] == positionIds[c])
+      {
+        continue;
+      }
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = c;
+    }
+    result.resize(write);
+  }
+
+  if (outError != 0)
+  {
+    *outError = (float) (sqrt(reached) / extent);
+  }
+  return result;
+}
+
+Mesh SimplifyMesh(Mesh& mesh, float ratio, float maxError, float maxWeightDelta, float* outError)
+{
+  Mesh result;
+  result.GetPosition() = mesh.GetPosition();
+  result.GetNormal() = mesh.GetNormal();
+  result.GetTexCoord() = mesh.GetTexCoord();
+  result.GetWeights() = mesh.GetWeights();
+  result.GetInfluences() = mesh.GetInfluences();
+  result.SetMaxInfluences(mesh.GetMaxInfluences());
+  result.GetMorphTargets() = mesh.GetMorphTargets();
+  unsigned int numTris = (unsigned int) mesh.GetIndices().size() / 3;
+  unsigned int target = (unsigned int) (numTris * ratio) * 3;
+  result.GetIndices() = SimplifyIndices(mesh, target, maxError, maxWeightDelta, outError);
+  OptimizeVertexCache(result.GetIndices(), (unsigned int) result.GetPosition().size());
+  OptimizeVertexFetch(result);
+  return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+// edge collapse simplification for skinned meshes. a vertex collapses
+// onto a neighbour it shares an edge with (no new vertices), costed
+// with area weighted quadrics (Garland-Heckbert). so collapses stay
+// safe to skin and texture:
+//   UV/normal seams and open borders are locked, seam vertices are
+//   the ones sharing a position with a vertex of different attributes
+//   two vertices only collapse if their skin weights differ by at
+//   most maxWeightDelta (sum of per joint differences, 0 to 2)
+//   collapses that flip a triangle are rejected
+// maxError is relative to the mesh extent (largest bounds axis)
+// morph targets don't affect the cost, the kept vertices keep their
+// deltas and collapsed ones take their neighbour's
+
+// returns a new index buffer over the same vertices with at most
+// targetIndexCount indices if it could get there within maxError.
+// outError gets the error reached, relative to the extent
+std::vector<unsigned int> SimplifyIndices(Mesh& mesh, unsigned int targetIndexCount,
+  float maxError = 0.05f, float maxWeightDelta = 0.5f, float* outError = 0);
+
+// CPU only copy of mesh at about ratio of its triangles, unused
+// vertices dropped and the rest reordered for the vertex cache
+Mesh SimplifyMesh(Mesh& mesh, float ratio, float maxError = 0.05f,
+  float maxWeightDelta = 0.5f, float* outError = 0);
@@ -0,0 +1,170 @@
+#include "MorphTarget.h"
+#include <algorithm>
+
+MorphTarget::MorphTarget()
+{
+}
+
+void MorphTarget::Set(const std::vector<unsigned int>& vertices, const std::vector<vec3>& positions,
+  const std::vector<vec3>& normals)
+{
+  m_Runs.clear();
+  m_PositionDeltas.clear();
+  m_NormalDeltas.clear();
+  unsigned int count = (unsigned int) vertices.size();
+  bool hasNormals = normals.size() == count && count > 0;
+
+  // sorted by vertex, ties in input order so the first one wins
+  std::vector<unsigned int> order;
+  order.reserve(count);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    const vec3& p = positions[i];
+    bool moves = p.x != 0.0f || p.y != 0.0f || p.z != 0.0f;
+    if (hasNormals)
+    {
+      const vec3& n = normals[i];
+      moves = moves || n.x != 0.0f || n.y != 0.0f || n.z != 0.0f;
+    }
+    if (moves)
+    {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&vertices](unsigned int a, unsigned int b) {
+    return vertices[a] < vertices[b];
+  });
+
+  m_PositionDeltas.reserve(order.size());
+  if (hasNormals)
+  {
+    m_NormalDeltas.reserve(order.size());
+  }
+  for (unsigned int i = 0, size = (unsigned int) order.size(); i < size; ++i)
+  {
+    unsigned int vertex = vertices[order[i]];
+    if (m_Runs.size() > 0)
+    {
+      MorphRun& last = m_Runs.back();
+      if (vertex < last.start + last.count)
+      {
+        continue;
+      }
+      if (vertex == last.start + last.count)
+      {
+        ++last.count;
+      }
+      else
+      {
+        MorphRun run = { vertex, 1 };
+        m_Runs.push_back(run);
+      }
+    }
+    else
+    {
+      MorphRun run = { vertex, 1 };
+      m_Runs.push_back(run);
+    }
+    m_PositionDeltas.push_back(positions[order[i]]);
+    if (hasNormals)
+    {
+      m_NormalDeltas.push_back(normals[order[i]]);
+    }
+  }
+}
+
+void MorphTarget::Remap(const std::vector<unsigned int>& remap, unsigned int newCount)
+{
+  std::vector<unsigned int> vertices;
+  std::vector<vec3> positions;
+  std::vector<vec3> normals;
+  vertices.reserve(m_PositionDeltas.size());
+  positions.reserve(m_PositionDeltas.size());
+  normals.reserve(m_NormalDeltas.size());
+  bool hasNormals = m_NormalDeltas.size() > 0;
+  unsigned int delta = 0;
+  for (unsigned int r = 0, numRuns = (unsigned int) m_Runs.size(); r < numRuns; ++r)
+  {
+    MorphRun& run = m_Runs[r];
+    for (unsigned int i = 0; i < run.count; ++i, ++delta)
+    {
+      unsigned int vertex = run.start + i;
+      if (vertex >= remap.size() || remap[vertex] >= newCount)
+      {
+        continue;
+      }
+      vertices.push_back(remap[vertex]);
+      positions.push_back(m_PositionDeltas[delta]);
+      if (hasNormals)
+      {
+        normals.push_back(m_NormalDeltas[delta]);
+      }
+    }
+  }
+  Set(vertices, positions, normals);
+}
+
+void MorphTarget::Apply(vec3* positions, vec3* normals, float weight)
+{
+  if (weight == 0.0f)
+  {
+    return;
+  }
+  bool hasNormals = normals != 0 && m_NormalDeltas.size() > 0;
+  unsigned int delta = 0;
+  for (unsigned int r = 0, numRuns = (unsigned int) m_Runs.size(); r < numRuns; ++r)
+  {
+    MorphRun& run = m_Runs[r];
+    vec3* p = positions + run.start;
+    const vec3* d = &m_PositionDeltas[delta];
+    for (unsigned int i = 0; i < run.count; ++i)
+    {
+      p[i] = p[i] + d[i] * weight;
+    }
+    if (hasNormals)
+    {
+      vec3* n = normals + run.start;
+      const vec3* dn = &m_NormalDeltas[delta];
+      for (unsigned int i = 0; i < run.count; ++i)
+      {
+        n[i] = n[i] + dn[i] * weight;
+      }
+    }
+    delta += run.count;
+  }
+}
+
+std::string& MorphTarget::GetName()
+{
+  return m_Name;
+}
+
+void MorphTarget::SetName(const std::string& name)
+{
+  m_Name = name;
+}
+
+std::vector<MorphRun>& MorphTarget::GetRuns()
+{
+  return m_Runs;
+}
+
+std::vector<vec3>& MorphTarget::GetPositionDeltas()
+{
+  return m_PositionDeltas;
+}
+
+std::vector<vec3>& MorphTarget::GetNormalDeltas()
+{
+  return m_NormalDeltas;
+}
+
+unsigned int MorphTarget::GetAffectedCount()
+{
+  return (unsigned int) m_PositionDeltas.size();
+}
+
+size_t MorphTarget::GetBytes()
+{
+  return m_Runs.size() * sizeof(MorphRun) + (m_PositionDeltas.size() + m_NormalDeltas.size()) * sizeof(vec3);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Math.h"
+#include <string>
+#include <vector>
+
+// consecutive vertices [start, start + count) moved by a target
+struct MorphRun
+{
+  unsigned int start;
+  unsigned int count;
+};
+
+class MorphTarget {
+  // one blend shape, kept sparse: only the vertices the target
+  // moves are stored, as runs of consecutive vertex indices plus one
+  // delta per affected vertex, run after run. a face target usually
+  // touches a few percent of the mesh, so this is a fraction of a
+  // dense delta array and applying it only walks what moves
+  // normal deltas are empty when the target has none
+protected:
+  std::string m_Name;
+  std::vector<MorphRun> m_Runs;
+  std::vector<vec3> m_PositionDeltas;
+  std::vector<vec3> m_NormalDeltas;
+
+public:
+  MorphTarget();
+  // vertex, delta pairs in any order. vertices with zero deltas are
+  // dropped, a repeated vertex keeps its first delta. normals is
+  // either empty or one per vertex
+  void Set(const std::vector<unsigned int>& vertices, const std::vector<vec3>& positions,
+    const std::vector<vec3>& normals);
+  // follows a vertex remap (old index -> new index), vertices
+  // mapped to newCount or past it are dropped. welded vertices
+  // have the same deltas, the first one is kept
+  void Remap(const std::vector<unsigned int>& remap, unsigned int newCount);
+  // adds weight * delta to every affected vertex, normals may be 0
+  // (they need renormalizing after all targets are applied)
+  void Apply(vec3* positions, vec3* normals, float weight);
+
+  std::string& GetName();
+  void SetName(const std::string& name);
+  std::vector<MorphRun>& GetRuns();
+  std::vector<vec3>& GetPositionDeltas();
+  std::vector<vec3>& GetNormalDeltas();
+  // how many vertices the target moves
+  unsigned int GetAffectedCount();
+  size_t GetBytes();
+};
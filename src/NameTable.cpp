@@ -0,0 +1,164 @@
+#include "NameTable.h"
+#include <cstring>
+
+NameTable::NameTable()
+{
+  m_Offsets.push_back(0);
+}
+
+NameTable::NameTable(const std::vector<std::string>& names)
+{
+  Build(names);
+}
+
+void NameTable::Build(const std::vector<std::string>& names)
+{
+  Clear();
+  unsigned int numNames = (unsigned int) names.size();
+  size_t numChars = 0;
+  for (unsigned int i = 0; i < numNames; ++i)
+  {
+    numChars += names[i].size() + 1;
+  }
+  m_Chars.reserve(numChars);
+  Reserve(numNames);
+  for (unsigned int i = 0; i < numNames; ++i)
+  {
+    Add(names[i]);
+  }
+}
+
+// sized so numNames fit without going over half full
+void NameTable::Reserve(unsigned int numNames)
+{
+  m_Offsets.reserve(numNames + 1);
+  m_Hashes.reserve(numNames);
+  unsigned int capacity = 16;
+  while (capacity < numNames * 2)
+  {
+    capacity *= 2;
+  }
+  if (capacity > m_Slots.size())
+  {
+    Grow(capacity);
+  }
+}
+
+void NameTable::Clear()
+{
+  m_Slots.clear();
+  m_Chars.clear();
+  m_Offsets.clear();
+  m_Offsets.push_back(0);
+  m_Hashes.clear();
+}
+
+void NameTable::Grow(unsigned int capacity)
+{
+  m_Slots.assign(capacity, Slot());
+  for (unsigned int i = 0, size = (unsigned int) m_Hashes.size(); i < size; ++i)
+  {
+    // a repeated name may already be in, only the first one counts
+    if (m_Offsets[i + 1] - m_Offsets[i] > 1 && Find(&m_Chars[m_Offsets[i]], m_Offsets[i + 1] - m_Offsets[i] - 1) < 0)
+    {
+      Insert(m_Hashes[i], i);
+    }
+  }
+}
+
+void NameTable::Insert(uint32_t hash, unsigned int index)
+{
+  unsigned int mask = (unsigned int) m_Slots.size() - 1;
+  unsigned int slot = hash & mask;
+  while (m_Slots[slot].index != 0)
+  {
+    slot = (slot + 1) & mask;
+  }
+  m_Slots[slot].hash = hash;
+  m_Slots[slot].index = index + 1;
+}
+
+unsigned int NameTable::Add(const char* name, size_t length)
+{
+  unsigned int index = (unsigned int) m_Hashes.size();
+  uint32_t hash = Hash(name, length);
+  bool findable = length > 0 && Find(name, length) < 0;
+  m_Chars.insert(m_Chars.end(), name, name + length);
+  m_Chars.push_back('\0');
+  m_Offsets.push_back((unsigned int) m_Chars.size());
+  m_Hashes.push_back(hash);
+  if (findable)
+  {
+    if ((index + 1) * 2 > m_Slots.size())
+    {
+      // rehashes every name, this one included
+      Grow(m_Slots.size() < 16 ? 16 : (unsigned int) m_Slots.size() * 2);
+    }
+    else
+    {
+      Insert(hash, index);
+    }
+  }
+  return index;
+}
+
+unsigned int NameTable::Add(const std::string& name)
+{
+  return Add(name.c_str(), name.size());
+}
+
+int NameTable::Find(const char* name, size_t length)
+{
+  if (m_Slots.size() == 0)
+  {
+    return -1;
+  }
+  uint32_t hash = Hash(name, length);
+  unsigned int mask = (unsigned int) m_Slots.size() - 1;
+  unsigned int slot = hash & mask;
+  while (m_Slots[slot].index != 0)
+  {
+    if (m_Slots[slot].hash == hash)
+    {
+      unsigned int index = m_Slots[slot].index - 1;
+      unsigned int offset = m_Offsets[index];
+      if (m_Offsets[index + 1] - offset - 1 == length && memcmp(&m_Chars[offset], name, length) == 0)
+      {
+        return (int) index;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+  return -1;
+}
+
+int NameTable::Find(const char* name)
+{
+  return Find(name, strlen(name));
+}
+
+int NameTable::Find(const std::string& name)
+{
+  return Find(name.c_str(), name.size());
+}
+
+unsigned int NameTable::Size()
+{
+  return (unsigned int) m_Hashes.size();
+}
+
+const char* NameTable::GetName(unsigned int index)
+{
+  return &m_Chars[m_Offsets[index]];
+}
+
+// 32 bit FNV-1a, names are short
+uint32_t NameTable::Hash(const char* name, size_t length)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i)
+  {
+    hash = (hash ^ (unsigned char) name[i]) * 16777619u;
+  }
+  return hash;
+}
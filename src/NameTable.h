@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NameTable {
+  // name -> index lookup for joints, clips and nodes, built once at
+  // import. open addressing with linear probing over a power of two
+  // slot array kept at most half full, each slot holds the name's
+  // hash so a probe only touches the string on a likely match
+  // the names are packed into one char array, the table is cheap to
+  // copy and doesn't point into anything else
+  // indices are the order names were added in. a repeated name gets
+  // its own index but Find always returns the first one, empty names
+  // are kept for the indices but can't be found
+protected:
+  struct Slot
+  {
+    uint32_t hash;
+    unsigned int index; // index + 1, 0 is an empty slot
+  };
+
+  std::vector<Slot> m_Slots;
+  std::vector<char> m_Chars;
+  std::vector<unsigned int> m_Offsets; // Size() + 1, into m_Chars
+  std::vector<uint32_t> m_Hashes;
+
+protected:
+  void Grow(unsigned int capacity);
+  void Insert(uint32_t hash, unsigned int index);
+
+public:
+  NameTable();
+  NameTable(const std::vector<std::string>& names);
+  void Build(const std::vector<std::string>& names);
+  void Reserve(unsigned int numNames);
+  void Clear();
+  // returns the new name's index
+  unsigned int Add(const char* name, size_t length);
+  unsigned int Add(const std::string& name);
+
+  // -1 if no name matches
+  int Find(const char* name, size_t length);
+  int Find(const char* name);
+  int Find(const std::string& name);
+
+  unsigned int Size();
+  const char* GetName(unsigned int index);
+
+  static uint32_t Hash(const char* name, size_t length);
+};
@@ -0,0 +1,181 @@
+#include "Pose.h"
+
+Pose::Pose() {}
+
+Pose::Pose(unsigned int numJoints)
+{
+  Resize(numJoints);
+}
+
+void Pose::Resize(unsigned int size)
+{
+  m_Parents.resize(size);
+  m_Joints.resize(size);
+}
+
+void Pose::Set(const TransformA* joints, const int* parents, unsigned int size)
+{
+  m_Joints.assign(joints, joints + size);
+  m_Parents.assign(parents, parents + size);
+}
+
+unsigned int Pose::Size()
+{
+  return (unsigned int) m_Joints.size();
+}
+
+int Pose::GetParent(unsigned int index)
+{
+  return m_Parents[index];
+}
+
+void Pose::SetParent(unsigned int index, int parent)
+{
+  m_Parents[index] = parent;
+}
+
+Transform Pose::GetLocalTransform(unsigned int index)
+{
+  return toTransform(m_Joints[index]);
+}
+
+void Pose::SetLocalTransform(unsigned int index, const Transform& transform)
+{
+  m_Joints[index] = toTransformA(transform);
+}
+
+// walk up the hierarchy, combining each parent with the result
+Transform Pose::GetGlobalTransform(unsigned int index)
+{
+  Transform result = toTransform(m_Joints[index]);
+  for (int p = m_Parents[index]; p >= 0; p = m_Parents[p])
+  {
+    result = combine(toTransform(m_Joints[p]), result);
+  }
+  return result;
+}
+
+Transform Pose::operator[](unsigned int index)
+{
+  return GetGlobalTransform(index);
+}
+
+// when parents come before their children, the global matrix of
+// a joint is its parent's (already computed) palette entry times
+// its local matrix, so the whole palette is one linear pass
+// any joint out of order falls back to walking the hierarchy
+void Pose::GetMatrixPalette(std::vector<mat4>& out)
+{
+  unsigned int size = Size();
+  if (out.size() != size)
+  {
+    out.resize(size);
+  }
+  if (size == 0)
+  {
+    return;
+  }
+
+  // all local matrices in one batch, then concatenate parents in place
+  transformToMat4(&m_Joints[0], &out[0], size);
+
+  unsigned int i = 0;
+  for (; i < size; ++i)
+  {
+    int parent = m_Parents[i];
+    if (parent > (int) i)
+    {
+      break;
+    }
+    if (parent >= 0)
+    {
+      out[i] = out[parent] * out[i];
+    }
+  }
+  for (; i < size; ++i)
+  {
+    out[i] = transformToMat4(GetGlobalTransform(i));
+  }
+}
+
+// same linear pass as the matrix palette, the left dual quat is
+// applied first so the local joint goes on the left of its parent
+void Pose::GetDualQuaternionPalette(std::vector<dualquat>& out)
+{
+  unsigned int size = Size();
+  if (out.size() != size)
+  {
+    out.resize(size);
+  }
+
+  unsigned int i = 0;
+  for (; i < size; ++i)
+  {
+    int parent = m_Parents[i];
+    if (parent > (int) i)
+    {
+      break;
+    }
+    dualquat global = transformToDualQuat(toTransform(m_Joints[i]));
+    if (parent >= 0)
+    {
+      global = global * out[parent];
+    }
+    out[i] = global;
+  }
+  for (; i < size; ++i)
+  {
+    out[i] = transformToDualQuat(GetGlobalTransform(i));
+  }
+}
+
+void Pose::GetHalfTransforms(std::vector<HalfTransform>& out)
+{
+  unsigned int size = Size();
+  out.resize(size);
+  if (size > 0)
+  {
+    toHalf(&m_Joints[0], &out[0], size);
+  }
+}
+
+// the pose has to be sized (and its parents set) already
+void Pose::SetHalfTransforms(const std::vector<HalfTransform>& in)
+{
+  unsigned int size = Size();
+  if (in.size() < size)
+  {
+    size = (unsigned int) in.size();
+  }
+  if (size > 0)
+  {
+    toFloat(&in[0], &m_Joints[0], size);
+  }
+}
+
+bool Pose::operator==(const Pose& other)
+{
+  if (m_Joints.size() != other.m_Joints.size())
+  {
+    return false;
+  }
+  unsigned int size = (unsigned int) m_Joints.size();
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    const TransformA& a = m_Joints[i];
+    const TransformA& b = other.m_Joints[i];
+    if (m_Parents[i] != other.m_Parents[i]
+      || vec3(a.position) != vec3(b.position)
+      || a.rotation != b.rotation
+      || vec3(a.scale) != vec3(b.scale))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Pose::operator!=(const Pose& other)
+{
+  return !(*this == other);
+}
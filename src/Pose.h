@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Transform.h"
+#include "Half.h"
+#include <vector>
+
+class Pose {
+  // a pose is the transform of every joint in a skeleton
+  // joints are stored as a flat array of local transforms plus
+  // the index of each joint's parent (-1 for a root joint)
+  // local transforms are kept as 16 byte aligned TransformA
+protected:
+  std::vector<TransformA> m_Joints;
+  std::vector<int> m_Parents;
+
+public:
+  Pose();
+  Pose(unsigned int numJoints);
+  void Resize(unsigned int size);
+  // bulk copy of local transforms and parents (baked files)
+  void Set(const TransformA* joints, const int* parents, unsigned int size);
+  unsigned int Size();
+  int GetParent(unsigned int index);
+  void SetParent(unsigned int index, int parent);
+  Transform GetLocalTransform(unsigned int index);
+  void SetLocalTransform(unsigned int index, const Transform& transform);
+  Transform GetGlobalTransform(unsigned int index);
+  Transform operator[](unsigned int index);
+
+  // skinning palettes, one entry per joint in global (model) space
+  // the dual quat palette is half the size of the matrix palette
+  // but drops joint scale
+  void GetMatrixPalette(std::vector<mat4>& out);
+  void GetDualQuaternionPalette(std::vector<dualquat>& out);
+
+  // half precision copy of the local transforms, for caching or
+  // replicating poses at half the memory (20 bytes per joint)
+  void GetHalfTransforms(std::vector<HalfTransform>& out);
+  void SetHalfTransforms(const std::vector<HalfTransform>& in);
+
+  bool operator==(const Pose& other);
+  bool operator!=(const Pose& other);
+};
@@ -0,0 +1,214 @@
+#include "Quantize.h"
+#include <cmath>
+
+static_assert(sizeof(snorm16x4) == 8, "snorm16x4 must be 8 bytes");
+static_assert(sizeof(snorm16x2) == 4, "snorm16x2 must be 4 bytes");
+static_assert(sizeof(hvec2) == 4, "hvec2 must be 4 bytes");
+
+static inline short toSnorm16(float f)
+{
+  f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+  return (short) lroundf(f * 32767.0f);
+}
+
+// same as the GL normalized fetch, -32768 and -32767 both map to -1
+static inline float fromSnorm16(short s)
+{
+  float f = (float) s / 32767.0f;
+  return f < -1.0f ? -1.0f : f;
+}
+
+QuantizationBounds getQuantizationBounds(const vec3* positions, unsigned int count)
+{
+  QuantizationBounds result;
+  result.offset = vec3(0, 0, 0);
+  result.scale = vec3(1, 1, 1);
+  if (count == 0)
+  {
+    return result;
+  }
+  vec3 minimum = positions[0];
+  vec3 maximum = positions[0];
+  for (unsigned int i = 1; i < count; ++i)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      minimum.v[c] = fminf(minimum.v[c], positions[i].v[c]);
+      maximum.v[c] = fmaxf(maximum.v[c], positions[i].v[c]);
+    }
+  }
+  for (int c = 0; c < 3; ++c)
+  {
+    result.offset.v[c] = (minimum.v[c] + maximum.v[c]) * 0.5f;
+    float extent = (maximum.v[c] - minimum.v[c]) * 0.5f;
+    // flat axis, any scale works
+    result.scale.v[c] = extent > 0.0f ? extent : 1.0f;
+  }
+  return result;
+}
+
+snorm16x4 quantizePosition(const vec3& p, const QuantizationBounds& bounds)
+{
+  snorm16x4 result;
+  result.x = toSnorm16((p.x - bounds.offset.x) / bounds.scale.x);
+  result.y = toSnorm16((p.y - bounds.offset.y) / bounds.scale.y);
+  result.z = toSnorm16((p.z - bounds.offset.z) / bounds.scale.z);
+  result.w = 32767;
+  return result;
+}
+
+vec3 dequantizePosition(const snorm16x4& q, const QuantizationBounds& bounds)
+{
+  return vec3(
+    bounds.offset.x + bounds.scale.x * fromSnorm16(q.x),
+    bounds.offset.y + bounds.scale.y * fromSnorm16(q.y),
+    bounds.offset.z + bounds.scale.z * fromSnorm16(q.z));
+}
+
+static inline float signNotZero(float f)
+{
+  return f >= 0.0f ? 1.0f : -1.0f;
+}
+
+vec3 octDecode(const snorm16x2& q)
+{
+  float x = fromSnorm16(q.x);
+  float y = fromSnorm16(q.y);
+  float z = 1.0f - fabsf(x) - fabsf(y);
+  // lower hemisphere is folded over the diagonals
+  float t = z < 0.0f ? -z : 0.0f;
+  x += x >= 0.0f ? -t : t;
+  y += y >= 0.0f ? -t : t;
+  float length = sqrtf(x * x + y * y + z * z);
+  if (length == 0.0f)
+  {
+    return vec3(0, 0, 1);
+  }
+  return vec3(x / length, y / length, z / length);
+}
+
+snorm16x2 octEncode(const vec3& n)
+{
+  float sum = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+  if (sum == 0.0f)
+  {
+    snorm16x2 up = { 0, 0 };
+    return up;
+  }
+  float x = n.x / sum;
+  float y = n.y / sum;
+  if (n.z < 0.0f)
+  {
+    float fx = (1.0f - fabsf(y)) * signNotZero(x);
+    float fy = (1.0f - fabsf(x)) * signNotZero(y);
+    x = fx;
+    y = fy;
+  }
+
+  // plain rounding can be off by most of a step, try all four
+  // floor/ceil pairs and keep the one closest to n
+  float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+  vec3 unit(n.x / length, n.y / length, n.z / length);
+  float fx = floorf(x * 32767.0f);
+  float fy = floorf(y * 32767.0f);
+  snorm16x2 best = { toSnorm16(x), toSnorm16(y) };
+  float bestDot = -2.0f;
+  for (int i = 0; i < 4; ++i)
+  {
+    snorm16x2 candidate;
+    candidate.x = toSnorm16((fx + (float) (i & 1)) / 32767.0f);
+    candidate.y = toSnorm16((fy + (float) (i >> 1)) / 32767.0f);
+    vec3 decoded = octDecode(candidate);
+    float d = decoded.x * unit.x + decoded.y * unit.y + decoded.z * unit.z;
+    if (d > bestDot)
+    {
+      bestDot = d;
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+unorm8x4 quantizeWeights(const vec4& w)
+{
+  int q[4];
+  int sum = 0;
+  int largest = 0;
+  for (int c = 0; c < 4; ++c)
+  {
+    float f = w.v[c] < 0.0f ? 0.0f : (w.v[c] > 1.0f ? 1.0f : w.v[c]);
+    q[c] = (int) lroundf(f * 255.0f);
+    sum += q[c];
+    if (q[c] > q[largest])
+    {
+      largest = c;
+    }
+  }
+  // rounding error goes to the biggest weight, it moves the least
+  if (sum > 0)
+  {
+    q[largest] += 255 - sum;
+    if (q[largest] < 0)
+    {
+      q[largest] = 0;
+    }
+  }
+  unorm8x4 result;
+  result.x = (unsigned char) q[0];
+  result.y = (unsigned char) q[1];
+  result.z = (unsigned char) q[2];
+  result.w = (unsigned char) q[3];
+  return result;
+}
+
+vec4 dequantizeWeights(const unorm8x4& q)
+{
+  return vec4(q.x / 255.0f, q.y / 255.0f, q.z / 255.0f, q.w / 255.0f);
+}
+
+static inline unsigned char toByte(int i)
+{
+  return (unsigned char) (i < 0 ? 0 : (i > 255 ? 255 : i));
+}
+
+ubyte4 quantizeJoints(const ivec4& j)
+{
+  ubyte4 result;
+  result.x = toByte(j.x);
+  result.y = toByte(j.y);
+  result.z = toByte(j.z);
+  result.w = toByte(j.w);
+  return result;
+}
+
+void quantizePositions(const vec3* in, snorm16x4* out, unsigned int count, const QuantizationBounds& bounds)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = quantizePosition(in[i], bounds);
+  }
+}
+
+void octEncode(const vec3* in, snorm16x2* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = octEncode(in[i]);
+  }
+}
+
+void quantizeWeights(const vec4* in, unorm8x4* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = quantizeWeights(in[i]);
+  }
+}
+
+void quantizeJoints(const ivec4* in, ubyte4* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = quantizeJoints(in[i]);
+  }
+}
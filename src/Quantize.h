@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Math.h"
+#include "Half.h"
+
+// packed vertex storage types, like Half.h these are for storing and
+// uploading only. the GPU unpacks them in the attribute fetch
+// (normalized) or the vertex shader (skinned_quantized.vert)
+
+// snorm16 position, xyz relative to the mesh bounds. w is padding so
+// the attribute stays 4 byte aligned
+struct snorm16x4
+{
+  short x;
+  short y;
+  short z;
+  short w;
+};
+
+// octahedral encoded unit vector
+struct snorm16x2
+{
+  short x;
+  short y;
+};
+
+// joint indices, read as integers
+struct ubyte4
+{
+  unsigned char x;
+  unsigned char y;
+  unsigned char z;
+  unsigned char w;
+};
+
+// skin weights, read as floats in [0, 1]
+struct unorm8x4
+{
+  unsigned char x;
+  unsigned char y;
+  unsigned char z;
+  unsigned char w;
+};
+
+// position = offset + scale * snorm, per axis
+struct QuantizationBounds
+{
+  vec3 offset;
+  vec3 scale;
+};
+
+QuantizationBounds getQuantizationBounds(const vec3* positions, unsigned int count);
+snorm16x4 quantizePosition(const vec3& p, const QuantizationBounds& bounds);
+vec3 dequantizePosition(const snorm16x4& q, const QuantizationBounds& bounds);
+
+// picks the rounding of the two components that decodes closest to n
+snorm16x2 octEncode(const vec3& n);
+vec3 octDecode(const snorm16x2& q);
+
+// the rounded weights always add up to 255
+unorm8x4 quantizeWeights(const vec4& w);
+vec4 dequantizeWeights(const unorm8x4& q);
+// joints over 255 are clamped, check the skeleton size first
+ubyte4 quantizeJoints(const ivec4& j);
+
+// batched versions
+void quantizePositions(const vec3* in, snorm16x4* out, unsigned int count, const QuantizationBounds& bounds);
+void octEncode(const vec3* in, snorm16x2* out, unsigned int count);
+void quantizeWeights(const vec4* in, unorm8x4* out, unsigned int count);
+void quantizeJoints(const ivec4* in, ubyte4* out, unsigned int count);
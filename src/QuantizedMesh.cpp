@@ -0,0 +1,305 @@
+#include "QuantizedMesh.h"
+#include "Draw.h"
+#include <iostream>
+
+QuantizedMesh::QuantizedMesh()
+{
+  m_Bounds.offset = vec3(0, 0, 0);
+  m_Bounds.scale = vec3(1, 1, 1);
+  m_VertexCount = 0;
+  m_PosAttrib = 0;
+  m_NormAttrib = 0;
+  m_UvAttrib = 0;
+  m_WeightAttrib = 0;
+  m_InfluenceAttrib = 0;
+  m_IndexBuffer = 0;
+}
+
+// same as Mesh, a copy gets its own buffers filled from the CPU data
+QuantizedMesh::QuantizedMesh(const QuantizedMesh& other)
+{
+  m_VertexCount = 0;
+  m_PosAttrib = 0;
+  m_NormAttrib = 0;
+  m_UvAttrib = 0;
+  m_WeightAttrib = 0;
+  m_InfluenceAttrib = 0;
+  m_IndexBuffer = 0;
+  *this = other;
+}
+
+void QuantizedMesh::CreateOpenGLBuffers()
+{
+  if (m_PosAttrib != 0)
+  {
+    return;
+  }
+  m_PosAttrib = new Attribute<snorm16x4>();
+  m_NormAttrib = new Attribute<snorm16x2>();
+  m_UvAttrib = new Attribute<hvec2>();
+  m_WeightAttrib = new Attribute<unorm8x4>();
+  m_InfluenceAttrib = new Attribute<ubyte4>();
+  m_IndexBuffer = new IndexBuffer();
+}
+
+QuantizedMesh& QuantizedMesh::operator=(const QuantizedMesh& other)
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+  m_Position = other.m_Position;
+  m_Normal = other.m_Normal;
+  m_TexCoord = other.m_TexCoord;
+  m_Weights = other.m_Weights;
+  m_Influences = other.m_Influences;
+  m_Indices = other.m_Indices;
+  m_Bounds = other.m_Bounds;
+  m_VertexCount = other.m_VertexCount;
+  if (other.HasGPUData())
+  {
+    UpdateOpenGLBuffers();
+  }
+  return *this;
+}
+
+QuantizedMesh::~QuantizedMesh()
+{
+  delete m_PosAttrib;
+  delete m_NormAttrib;
+  delete m_UvAttrib;
+  delete m_WeightAttrib;
+  delete m_InfluenceAttrib;
+  delete m_IndexBuffer;
+}
+
+bool QuantizedMesh::Set(Mesh& mesh)
+{
+  std::vector<vec3>& position = mesh.GetPosition();
+  unsigned int numVerts = (unsigned int) position.size();
+  if (numVerts == 0)
+  {
+    std::cout<<"Can't quantize a mesh without CPU data\n";
+    return false;
+  }
+  std::vector<ivec4>& influences = mesh.GetInfluences();
+  for (unsigned int i = 0, size = (unsigned int) influences.size(); i < size; ++i)
+  {
+    const ivec4& j = influences[i];
+    if (j.x > 255 || j.y > 255 || j.z > 255 || j.w > 255)
+    {
+      std::cout<<"Can't quantize joint index over 255\n";
+      return false;
+    }
+  }
+
+  m_Bounds = getQuantizationBounds(&position[0], numVerts);
+  m_Position.resize(numVerts);
+  quantizePositions(&position[0], &m_Position[0], numVerts, m_Bounds);
+  // streams that don't match the vertex count are left out, same as
+  // Mesh never uploading them
+  std::vector<vec3>& normal = mesh.GetNormal();
+  m_Normal.resize(normal.size() == numVerts ? numVerts : 0);
+  if (m_Normal.size() > 0)
+  {
+    octEncode(&normal[0], &m_Normal[0], numVerts);
+  }
+  std::vector<vec2>& texCoord = mesh.GetTexCoord();
+  m_TexCoord.resize(texCoord.size() == numVerts ? numVerts : 0);
+  if (m_TexCoord.size() > 0)
+  {
+    toHalf(&texCoord[0], &m_TexCoord[0], numVerts);
+  }
+  std::vector<vec4>& weights = mesh.GetWeights();
+  m_Weights.resize(weights.size() == numVerts ? numVerts : 0);
+  if (m_Weights.size() > 0)
+  {
+    quantizeWeights(&weights[0], &m_Weights[0], numVerts);
+  }
+  m_Influences.resize(influences.size() == numVerts ? numVerts : 0);
+  if (m_Influences.size() > 0)
+  {
+    quantizeJoints(&influences[0], &m_Influences[0], numVerts);
+  }
+  m_Indices = mesh.GetIndices();
+  m_VertexCount = numVerts;
+  return true;
+}
+
+std::vector<snorm16x4>& QuantizedMesh::GetPosition()
+{
+  return m_Position;
+}
+
+std::vector<snorm16x2>& QuantizedMesh::GetNormal()
+{
+  return m_Normal;
+}
+
+std::vector<hvec2>& QuantizedMesh::GetTexCoord()
+{
+  return m_TexCoord;
+}
+
+std::vector<unorm8x4>& QuantizedMesh::GetWeights()
+{
+  return m_Weights;
+}
+
+std::vector<ubyte4>& QuantizedMesh::GetInfluences()
+{
+  return m_Influences;
+}
+
+std::vector<unsigned int>& QuantizedMesh::GetIndices()
+{
+  return m_Indices;
+}
+
+QuantizationBounds& QuantizedMesh::GetBounds()
+{
+  return m_Bounds;
+}
+
+unsigned int QuantizedMesh::GetVertexCount()
+{
+  return m_VertexCount;
+}
+
+void QuantizedMesh::UpdateOpenGLBuffers()
+{
+  CreateOpenGLBuffers();
+  if (m_Position.size() > 0)
+  {
+    m_VertexCount = (unsigned int) m_Position.size();
+    m_PosAttrib->Set(m_Position);
+  }
+  if (m_Normal.size() > 0)
+  {
+    m_NormAttrib->Set(m_Normal);
+  }
+  if (m_TexCoord.size() > 0)
+  {
+    m_UvAttrib->Set(m_TexCoord);
+  }
+  if (m_Weights.size() > 0)
+  {
+    m_WeightAttrib->Set(m_Weights);
+  }
+  if (m_Influences.size() > 0)
+  {
+    m_InfluenceAttrib->Set(m_Influences);
+  }
+  if (m_Indices.size() > 0)
+  {
+    m_IndexBuffer->Set(m_Indices);
+  }
+}
+
+void QuantizedMesh::ReleaseCPUData()
+{
+  std::vector<snorm16x4>().swap(m_Position);
+  std::vector<snorm16x2>().swap(m_Normal);
+  std::vector<hvec2>().swap(m_TexCoord);
+  std::vector<unorm8x4>().swap(m_Weights);
+  std::vector<ubyte4>().swap(m_Influences);
+  std::vector<unsigned int>().swap(m_Indices);
+}
+
+bool QuantizedMesh::HasCPUData()
+{
+  return m_Position.size() > 0;
+}
+
+bool QuantizedMesh::HasGPUData() const
+{
+  return m_PosAttrib != 0;
+}
+
+void QuantizedMesh::Bind(int position, int normal, int texCoord, int weight, int influence)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (position >= 0)
+  {
+    m_PosAttrib->BindTo(position);
+  }
+  if (normal >= 0)
+  {
+    m_NormAttrib->BindTo(normal);
+  }
+  if (texCoord >= 0)
+  {
+    m_UvAttrib->BindTo(texCoord);
+  }
+  if (weight >= 0)
+  {
+    m_WeightAttrib->BindTo(weight);
+  }
+  if (influence >= 0)
+  {
+    m_InfluenceAttrib->BindTo(influence);
+  }
+}
+
+void QuantizedMesh::Draw()
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (m_IndexBuffer->Count() > 0)
+  {
+    ::Draw(*m_IndexBuffer, DrawMode::Triangles);
+  }
+  else
+  {
+    ::Draw(m_VertexCount, DrawMode::Triangles);
+  }
+}
+
+void QuantizedMesh::DrawInstanced(unsigned int numInstances)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (m_IndexBuffer->Count() > 0)
+  {
+    ::DrawInstanced(*m_IndexBuffer, DrawMode::Triangles, numInstances);
+  }
+  else
+  {
+    ::DrawInstanced(m_VertexCount, DrawMode::Triangles, numInstances);
+  }
+}
+
+void QuantizedMesh::UnBind(int position, int normal, int texCoord, int weight, int influence)
+{
+  if (!HasGPUData())
+  {
+    return;
+  }
+  if (position >= 0)
+  {
+    m_PosAttrib->UnBindFrom(position);
+  }
+  if (normal >= 0)
+  {
+    m_NormAttrib->UnBindFrom(normal);
+  }
+  if (texCoord >= 0)
+  {
+    m_UvAttrib->UnBindFrom(texCoord);
+  }
+  if (weight >= 0)
+  {
+    m_WeightAttrib->UnBindFrom(weight);
+  }
+  if (influence >= 0)
+  {
+    m_InfluenceAttrib->UnBindFrom(influence);
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Quantize.h"
+#include <vector>
+
+class QuantizedMesh {
+  // packed GPU copy of a skinned Mesh, 24 bytes per vertex against
+  // 64: snorm16 positions relative to the mesh bounds, octahedral
+  // snorm16 normals, half UVs, uint8 joints and unorm8 weights
+  // drawn with skinned_quantized.vert, GetBounds goes into its
+  // positionOffset/positionScale uniforms. no CPU skinning, keep the
+  // float Mesh around for that
+  // GL buffers are only created on the first upload
+protected:
+  std::vector<snorm16x4> m_Position;
+  std::vector<snorm16x2> m_Normal;
+  std::vector<hvec2> m_TexCoord;
+  std::vector<unorm8x4> m_Weights;
+  std::vector<ubyte4> m_Influences;
+  std::vector<unsigned int> m_Indices;
+  QuantizationBounds m_Bounds;
+  unsigned int m_VertexCount;
+
+  Attribute<snorm16x4>* m_PosAttrib;
+  Attribute<snorm16x2>* m_NormAttrib;
+  Attribute<hvec2>* m_UvAttrib;
+  Attribute<unorm8x4>* m_WeightAttrib;
+  Attribute<ubyte4>* m_InfluenceAttrib;
+  IndexBuffer* m_IndexBuffer;
+
+protected:
+  void CreateOpenGLBuffers();
+
+public:
+  QuantizedMesh();
+  QuantizedMesh(const QuantizedMesh& other);
+  QuantizedMesh& operator=(const QuantizedMesh& other);
+  ~QuantizedMesh();
+
+  // packs the CPU copy of mesh, false if it has none or uses joints
+  // past 255
+  bool Set(Mesh& mesh);
+
+  std::vector<snorm16x4>& GetPosition();
+  std::vector<snorm16x2>& GetNormal();
+  std::vector<hvec2>& GetTexCoord();
+  std::vector<unorm8x4>& GetWeights();
+  std::vector<ubyte4>& GetInfluences();
+  std::vector<unsigned int>& GetIndices();
+  QuantizationBounds& GetBounds();
+  unsigned int GetVertexCount();
+
+  void UpdateOpenGLBuffers();
+  void ReleaseCPUData();
+  bool HasCPUData();
+  bool HasGPUData() const;
+
+  void Bind(int position, int normal, int texCoord, int weight, int influence);
+  void Draw();
+  void DrawInstanced(unsigned int numInstances);
+  void UnBind(int position, int normal, int texCoord, int weight, int influence);
+};
@@ -0,0 +1,73 @@
+#include "Skeleton.h"
+
+Skeleton::Skeleton() {}
+
+Skeleton::Skeleton(const Pose& rest, const Pose& bind, const std::vector<std::string>& names)
+{
+  Set(rest, bind, names);
+}
+
+void Skeleton::Set(const Pose& rest, const Pose& bind, const std::vector<std::string>& names)
+{
+  m_RestPose = rest;
+  m_BindPose = bind;
+  m_JointNames = names;
+  m_JointTable.Build(names);
+  UpdateInverseBindPose();
+}
+
+// the bind palette is built parent first in one pass, so the
+// inverse bind pose is just that palette inverted per joint
+void Skeleton::UpdateInverseBindPose()
+{
+  m_BindPose.GetMatrixPalette(m_InvBindPose);
+  for (unsigned int i = 0, size = (unsigned int) m_InvBindPose.size(); i < size; ++i)
+  {
+    invert(m_InvBindPose[i]);
+  }
+}
+
+unsigned int Skeleton::Size()
+{
+  return m_RestPose.Size();
+}
+
+Pose& Skeleton::GetRestPose()
+{
+  return m_RestPose;
+}
+
+Pose& Skeleton::GetBindPose()
+{
+  return m_BindPose;
+}
+
+std::vector<mat4>& Skeleton::GetInvBindPose()
+{
+  return m_InvBindPose;
+}
+
+std::vector<std::string>& Skeleton::GetJointNames()
+{
+  return m_JointNames;
+}
+
+std::string& Skeleton::GetJointName(unsigned int index)
+{
+  return m_JointNames[index];
+}
+
+int Skeleton::GetJointIndex(const std::string& name)
+{
+  return m_JointTable.Find(name);
+}
+
+int Skeleton::GetJointIndex(const char* name)
+{
+  return m_JointTable.Find(name);
+}
+
+NameTable& Skeleton::GetJointTable()
+{
+  return m_JointTable;
+}
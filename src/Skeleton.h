@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Pose.h"
+#include "Math.h"
+#include "NameTable.h"
+#include <vector>
+#include <string>
+
+class Skeleton {
+  // a skeleton is the shared, read only part of an animated model:
+  // the rest pose, the bind pose the mesh was skinned in, the
+  // inverse of every joint's bind matrix and the joint names
+  // joints are sorted so each parent comes before its children,
+  // global transforms are one linear pass over the arrays
+  // joint names are hashed (NameTable) when set, so finding a joint
+  // by name never scans the name list
+protected:
+  Pose m_RestPose;
+  Pose m_BindPose;
+  std::vector<mat4> m_InvBindPose;
+  std::vector<std::string> m_JointNames;
+  NameTable m_JointTable;
+
+protected:
+  void UpdateInverseBindPose();
+
+public:
+  Skeleton();
+  Skeleton(const Pose& rest, const Pose& bind, const std::vector<std::string>& names);
+  void Set(const Pose& rest, const Pose& bind, const std::vector<std::string>& names);
+
+  unsigned int Size();
+  Pose& GetRestPose();
+  Pose& GetBindPose();
+  std::vector<mat4>& GetInvBindPose();
+  std::vector<std::string>& GetJointNames();
+  std::string& GetJointName(unsigned int index);
+  // -1 if no joint has that name
+  int GetJointIndex(const std::string& name);
+  int GetJointIndex(const char* name);
+  NameTable& GetJointTable();
+};
@@ -1,16 +1,20 @@
 #include "Texture.h"
 #include "stb_image.h"
 #include <GL/glew.h>
+#include <iostream>
 
 
 Texture::Texture()
 {
   m_Width = 0; m_Height = 0; m_Channels = 0;
+  m_Ready = false;
   glGenTextures(1, &m_Handle);
 }
 
 Texture::Texture(const char* path)
 {
+    m_Width = 0; m_Height = 0; m_Channels = 0;
+    m_Ready = false;
     glGenTextures(1, &m_Handle);
     Load(path);
 }
@@ -23,12 +27,24 @@ Texture::~Texture()
 void Texture::Load(const char* path)
 {
 // all textures loaded with RGBA channels
-  glBindTexture(GL_TEXTURE_2D, m_Handle);
   int width, height, channels;
   unsigned char* data = stbi_load(path, &width, &height, &channels, 4);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-  glGenerateMipmap(GL_TEXTURE_2D);
+  if (data == 0)
+  {
+    std::cout<<"Could not load texture:"<<path<<"\n";
+    return;
+  }
+  Allocate(width, height, channels);
+  UploadRows(data, 0, height);
+  Finish();
   stbi_image_free(data);
+}
+
+void Texture::Allocate(unsigned int width, unsigned int height, unsigned int channels)
+{
+  m_Ready = false;
+  glBindTexture(GL_TEXTURE_2D, m_Handle);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
@@ -39,6 +55,36 @@ void Texture::Load(const char* path)
   m_Channels = channels;
 }
 
+void Texture::UploadRows(const unsigned char* pixels, unsigned int firstRow, unsigned int numRows)
+{
+  glBindTexture(GL_TEXTURE_2D, m_Handle);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, m_Width, numRows, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::Finish()
+{
+  glBindTexture(GL_TEXTURE_2D, m_Handle);
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  m_Ready = true;
+}
+
+bool Texture::IsReady()
+{
+  return m_Ready;
+}
+
+unsigned int Texture::GetWidth()
+{
+  return m_Width;
+}
+
+unsigned int Texture::GetHeight()
+{
+  return m_Height;
+}
+
 void Texture::Set(unsigned int uniformIndex, unsigned int textureIndex)
 {
   glActiveTexture(GL_TEXTURE0 + textureIndex);
@@ -3,16 +3,31 @@
 class Texture {
   // load texture from file, bind texture index to uniform index
   // and deactivate a texture index
+  // a texture can also be filled in steps (Allocate, UploadRows,
+  // Finish), TextureLoader uploads decoded images that way spread
+  // over frames. IsReady is false until the last step
 protected:
   unsigned int m_Width;
   unsigned int m_Height;
   unsigned int m_Channels;
   unsigned int m_Handle;
+  bool m_Ready;
 public:
   Texture();
   Texture(const char* path);
   ~Texture();
+  // decodes and uploads in one blocking call
   void Load(const char* path);
+  // storage for an RGBA image, contents undefined until uploaded
+  void Allocate(unsigned int width, unsigned int height, unsigned int channels);
+  // rows [firstRow, firstRow + numRows) of the allocated size, pixels
+  // points at the first of them, tightly packed RGBA
+  void UploadRows(const unsigned char* pixels, unsigned int firstRow, unsigned int numRows);
+  // builds the mipmaps, the texture is ready to sample afterwards
+  void Finish();
+  bool IsReady();
+  unsigned int GetWidth();
+  unsigned int GetHeight();
   void Set(unsigned int uniform, unsigned int texIndex);
   void UnSet(unsigned int textureIndex);
   unsigned int GetHandle();
@@ -0,0 +1,187 @@
+#include "TextureLoader.h"
+#include "stb_image.h"
+#include <iostream>
+
+TextureLoader::TextureLoader(unsigned int numThreads)
+{
+  m_Stopping = false;
+  m_Decoding = 0;
+  if (numThreads == 0)
+  {
+    unsigned int cores = std::thread::hardware_concurrency();
+    numThreads = cores > 1 ? cores - 1 : 1;
+  }
+  m_Workers.reserve(numThreads);
+  for (unsigned int i = 0; i < numThreads; ++i)
+  {
+    m_Workers.push_back(std::thread(&TextureLoader::WorkerLoop, this));
+  }
+}
+
+// render thread. queued files are dropped, files being decoded
+// finish first. anything not uploaded yet is never uploaded
+TextureLoader::~TextureLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    m_Stopping = true;
+    m_Queue.clear();
+  }
+  m_QueueSignal.notify_all();
+  for (unsigned int i = 0; i < m_Workers.size(); ++i)
+  {
+    m_Workers[i].join();
+  }
+  for (unsigned int i = 0; i < m_Uploads.size(); ++i)
+  {
+    stbi_image_free(m_Uploads[i]->pixels);
+  }
+  m_Uploads.clear();
+}
+
+std::shared_ptr<Texture> TextureLoader::Load(const std::string& path)
+{
+  std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>();
+  request->path = path;
+  request->texture = std::make_shared<Texture>();
+  request->pixels = 0;
+  request->width = 0;
+  request->height = 0;
+  request->channels = 0;
+  request->nextRow = 0;
+  std::shared_ptr<Texture> result = request->texture;
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    m_Queue.push_back(std::move(request));
+  }
+  m_QueueSignal.notify_one();
+  return result;
+}
+
+void TextureLoader::WorkerLoop()
+{
+  for (;;)
+  {
+    std::shared_ptr<TextureRequest> request;
+    {
+      std::unique_lock<std::mutex> lock(m_QueueLock);
+      m_QueueSignal.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+      if (m_Stopping)
+      {
+        return;
+      }
+      request = std::move(m_Queue.front());
+      m_Queue.pop_front();
+      ++m_Decoding;
+    }
+    Decode(std::move(request));
+    --m_Decoding;
+  }
+}
+
+// runs on a worker, nothing in here may call GL. stb_image is safe to
+// call from several threads as long as nobody changes its global
+// settings (flip on load) while decoding
+void TextureLoader::Decode(std::shared_ptr<TextureRequest> request)
+{
+  int width, height, channels;
+  // all textures loaded with RGBA channels, like Texture::Load
+  request->pixels = stbi_load(request->path.c_str(), &width, &height, &channels, 4);
+  if (request->pixels == 0)
+  {
+    std::cout<<"Could not load texture:"<<request->path<<"\n";
+  }
+  else
+  {
+    request->width = width;
+    request->height = height;
+    request->channels = channels;
+  }
+  std::lock_guard<std::mutex> lock(m_UploadLock);
+  m_Uploads.push_back(std::move(request));
+}
+
+unsigned int TextureLoader::Upload(TextureRequest& request, unsigned int budget)
+{
+  if (request.pixels == 0)
+  {
+    return 0;
+  }
+  Texture& texture = *request.texture;
+  if (request.nextRow == 0)
+  {
+    texture.Allocate(request.width, request.height, request.channels);
+  }
+  unsigned int rowBytes = request.width * 4;
+  unsigned int numRows = budget / rowBytes;
+  if (numRows == 0)
+  {
+    numRows = 1;
+  }
+  if (numRows > request.height - request.nextRow)
+  {
+    numRows = request.height - request.nextRow;
+  }
+  texture.UploadRows(request.pixels + (size_t) request.nextRow * rowBytes, request.nextRow, numRows);
+  request.nextRow += numRows;
+  if (request.nextRow >= request.height)
+  {
+    texture.Finish();
+    stbi_image_free(request.pixels);
+    request.pixels = 0;
+  }
+  return numRows * rowBytes;
+}
+
+void TextureLoader::Update(unsigned int uploadBudgetBytes)
+{
+  unsigned int budget = uploadBudgetBytes > 0 ? uploadBudgetBytes : 1;
+  unsigned int used = 0;
+  while (used < budget)
+  {
+    std::shared_ptr<TextureRequest> request;
+    {
+      std::lock_guard<std::mutex> lock(m_UploadLock);
+      if (m_Uploads.empty())
+      {
+        return;
+      }
+      request = m_Uploads.front();
+    }
+    used += Upload(*request, budget - used);
+    if (request->pixels != 0)
+    {
+      // budget ran out part way through this image
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_UploadLock);
+    m_Uploads.pop_front();
+  }
+}
+
+void TextureLoader::Finish()
+{
+  while (GetPendingCount() > 0)
+  {
+    Update(~0u);
+    std::this_thread::yield();
+  }
+}
+
+// files not uploaded yet. requests only move forward, queue ->
+// decoding -> uploads, so counting in that order can count one twice
+// but never miss one (uploads are only removed on this thread)
+unsigned int TextureLoader::GetPendingCount()
+{
+  unsigned int pending = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_QueueLock);
+    pending += (unsigned int) m_Queue.size();
+  }
+  pending += m_Decoding.load();
+  {
+    std::lock_guard<std::mutex> lock(m_UploadLock);
+    pending += (unsigned int) m_Uploads.size();
+  }
+  return pending;
+}
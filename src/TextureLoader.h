@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Texture.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// one queued texture file: decoded on a worker into pixels, then
+// uploaded a few rows at a time on the render thread
+struct TextureRequest
+{
+  std::string path;
+  std::shared_ptr<Texture> texture;
+  unsigned char* pixels; // RGBA from stb_image, 0 if decoding failed
+  unsigned int width;
+  unsigned int height;
+  unsigned int channels;
+  unsigned int nextRow;
+};
+
+class TextureLoader {
+  // decodes image files on a pool of worker threads, the render
+  // thread uploads the decoded images in Update within a per frame
+  // byte budget. big images are split by rows across frames, the
+  // mipmaps are built once the last row is in
+  // GL is never touched off the render thread, and workers never
+  // hold the last reference to a texture (failed decodes go through
+  // the upload queue too), so textures are always deleted there
+protected:
+  std::vector<std::thread> m_Workers;
+  std::deque<std::shared_ptr<TextureRequest>> m_Queue;
+  std::mutex m_QueueLock;
+  std::condition_variable m_QueueSignal;
+  bool m_Stopping;
+  std::atomic<unsigned int> m_Decoding;
+
+  std::deque<std::shared_ptr<TextureRequest>> m_Uploads;
+  std::mutex m_UploadLock;
+
+protected:
+  void WorkerLoop();
+  void Decode(std::shared_ptr<TextureRequest> request);
+  // returns bytes uploaded, stops once budget is used up
+  unsigned int Upload(TextureRequest& request, unsigned int budget);
+
+public:
+  // 0 threads = one per core, minus the render thread
+  TextureLoader(unsigned int numThreads = 0);
+  ~TextureLoader();
+
+  // render thread (creates the GL texture). the texture is usable
+  // right away and reports IsReady once uploaded, a file that can't
+  // be decoded leaves it never ready
+  std::shared_ptr<Texture> Load(const std::string& path);
+
+  // render thread: upload decoded images, at least one row per call
+  // so a frame always makes progress
+  void Update(unsigned int uploadBudgetBytes);
+  // render thread: wait for everything queued and upload it all
+  void Finish();
+  unsigned int GetPendingCount();
+
+private:
+  TextureLoader(const TextureLoader& other);
+  TextureLoader& operator=(const TextureLoader& other);
+};
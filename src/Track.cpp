@@ -1,5 +1,6 @@
 #include "Track.h"
 #include <cmath>
+#include <cstring>
 
 template Track<float, 1>;
 template Track<vec3, 3>;
@@ -81,6 +82,12 @@ void Track<T, N>::Resize(unsigned int size)
   m_Frames.resize(size);
 }
 
+template<typename T, int N>
+void Track<T, N>::Set(const Frame<N>* frames, unsigned int size)
+{
+  m_Frames.assign(frames, frames + size);
+}
+
 template<typename T, int N>
 unsigned int Track<T, N>::Size()
 {
@@ -134,7 +141,7 @@ int Track<T, N>::FrameIndex(float time, bool looping)
     time = time + startTime;
   }
   else {
-    if (time <= m_Frames[0].m_time)
+    if (time <= m_Frames[0].m_Time)
     {
       return 0;
     }
@@ -267,12 +274,13 @@ T Track<T, N>::SampleCubic(float time, bool looping)
   float t = (trackTime - thisTime) / frameDelta;
   size_t fltSize = sizeof(float);
   T point1 = Cast(&m_Frames[thisFrame].m_Value[0]);
-  T slope1 = m_Frames[thisFrame].m_Out * frameDelta;
-  memcpy(&slope1, m_Frames[thisFrame].m_out, N * fltSize);
+  // tangents are copied raw, Cast would normalize quat tangents
+  T slope1;
+  memcpy(&slope1, m_Frames[thisFrame].m_Out, N * fltSize);
   slope1 = slope1 * frameDelta;
 
   T point2 = Cast(&m_Frames[nextFrame].m_Value[0]);
-  T slope2 = m_Frames[nextFrame].m_In[0] * frameDelta;
+  T slope2;
   memcpy(&slope2, m_Frames[nextFrame].m_In, N * fltSize);
   slope2 = slope2 * frameDelta;
 
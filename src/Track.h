@@ -15,6 +15,8 @@ protected:
 public:
   Track();
   void Resize(unsigned int size);
+  // bulk copy of frames (baked files)
+  void Set(const Frame<N>* frames, unsigned int size);
   unsigned int Size();
   Interpolation GetInterpolation();
   void SetInterpolation(Interpolation interp);
@@ -35,11 +37,11 @@ protected:
   // get frame index for give time = last frame rigth before requested time
   int FrameIndex(float time, bool looping);
   T Cast(float* value); // will be specialized
-
-  typedef Track<float, 1>
-  ScalarTrack;
-  typedef Track<float,3>
-  VectorTrack;
-  typedef Track<float, 4>
-  QuaternionTrack;
 };
+
+typedef Track<float, 1>
+ScalarTrack;
+typedef Track<vec3, 3>
+VectorTrack;
+typedef Track<quat, 4>
+QuaternionTrack;
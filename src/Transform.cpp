@@ -1,6 +1,17 @@
 #include "Transform.h"
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define TRANSFORM_SSE
+#include <emmintrin.h>
+#endif
+
+// NOTE: vec3 * vec3 is the cross product, scale has to be
+// applied per component
+static vec3 scaled(const vec3& v, const vec3& s)
+{
+  return vec3(v.x * s.x, v.y * s.y, v.z * s.z);
+}
 
 // a transform maps from one space to another
 // combining transforms mantains a right-to-left order
@@ -11,9 +22,10 @@
 Transform combine(const Transform& a, Transform& b)
 {
   Transform out;
-  out.scale = a.scale * b.scale;
-  out.rotation = a.rotation * b.rotation;
-  out.position = a.rotation * (a.scale*b.position);
+  out.scale = scaled(a.scale, b.scale);
+  // the left quat is applied first, b is the child so it rotates first
+  out.rotation = b.rotation * a.rotation;
+  out.position = a.rotation * scaled(b.position, a.scale);
   out.position = a.position + out.position;
   return out;
 }
@@ -31,7 +43,7 @@ Transform inverse(const Transform& t)
   inv.scale.z = std::fabs(t.scale.z) < VEC_EPSILON ? 0.0f : 1.0f / t.scale.z;
 
   vec3 invTrans = t.position * -1.0f;
-  inv.position = inv.rotation * (inv.scale * invTrans);
+  inv.position = inv.rotation * scaled(invTrans, inv.scale);
 
   return inv;
 }
@@ -62,28 +74,112 @@ Transform mix(const Transform& a, const Transform& b, float t)
 // used to send data to shaders
 mat4 transformToMat4(const Transform& t)
 {
-    // extract the rotation basis of the transform
-    vec3 x = t.rotation * vec3(1, 0, 0);
-    vec3 y = t.rotation * vec3(0, 1, 0);
-    vec3 z = t.rotation * vec3(0, 0, 1);
+    // rotation basis, closed form (see quatToMat4)
+    const quat& q = t.rotation;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
 
-    // scale the basis the vectors
-    x = x * t.scale.x;
-    y = y * t.scale.y;
-    z = z * t.scale.z;
+    // scale the basis vectors
+    float sx = t.scale.x, sy = t.scale.y, sz = t.scale.z;
 
     // extract the position of the transform
     vec3 p = t.position;
 
     // create matrix
     return mat4(
-        x.x, x.y, x.z, 0 // X basis & scale
-      , y.x, y.y, y.z, 0 // Y basis & scale
-      , z.x, z.y, z.z, 0 // Z basis & scale
+        (1.0f - 2.0f * (yy + zz)) * sx, 2.0f * (xy + wz) * sx, 2.0f * (xz - wy) * sx, 0 // X basis & scale
+      , 2.0f * (xy - wz) * sy, (1.0f - 2.0f * (xx + zz)) * sy, 2.0f * (yz + wx) * sy, 0 // Y basis & scale
+      , 2.0f * (xz + wy) * sz, 2.0f * (yz - wx) * sz, (1.0f - 2.0f * (xx + yy)) * sz, 0 // Z basis & scale
       , p.x, p.y, p.z, 1 // position
     );
 }
 
+void transformToMat4(const Transform* in, mat4* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = transformToMat4(in[i]);
+  }
+}
+
+// TransformA keeps every member 16 byte aligned, so 4 transforms
+// at a time are loaded with aligned loads and transposed into
+// x, y, z, w lanes. the 9 basis terms are computed for all 4, then
+// transposed back into columns and stored straight into the palette
+void transformToMat4(const TransformA* in, mat4* out, unsigned int count)
+{
+  unsigned int i = 0;
+#ifdef TRANSFORM_SSE
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  for (; i + 4 <= count; i += 4)
+  {
+    const TransformA* t = in + i;
+    __m128 qx = _mm_load_ps(&t[0].rotation.x);
+    __m128 qy = _mm_load_ps(&t[1].rotation.x);
+    __m128 qz = _mm_load_ps(&t[2].rotation.x);
+    __m128 qw = _mm_load_ps(&t[3].rotation.x);
+    _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+    __m128 sx = _mm_load_ps(&t[0].scale.x);
+    __m128 sy = _mm_load_ps(&t[1].scale.x);
+    __m128 sz = _mm_load_ps(&t[2].scale.x);
+    __m128 sw = _mm_load_ps(&t[3].scale.x);
+    _MM_TRANSPOSE4_PS(sx, sy, sz, sw);
+
+    __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+    __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+    __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+    // one register per matrix element, lane n belongs to transform n
+    __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+    __m128 zero = _mm_setzero_ps();
+
+    __m128 a = m00, b = m01, c = m02, d = zero;
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_store_ps(out[i + 0].v + 0, a);
+    _mm_store_ps(out[i + 1].v + 0, b);
+    _mm_store_ps(out[i + 2].v + 0, c);
+    _mm_store_ps(out[i + 3].v + 0, d);
+
+    a = m10; b = m11; c = m12; d = zero;
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_store_ps(out[i + 0].v + 4, a);
+    _mm_store_ps(out[i + 1].v + 4, b);
+    _mm_store_ps(out[i + 2].v + 4, c);
+    _mm_store_ps(out[i + 3].v + 4, d);
+
+    a = m20; b = m21; c = m22; d = zero;
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_store_ps(out[i + 0].v + 8, a);
+    _mm_store_ps(out[i + 1].v + 8, b);
+    _mm_store_ps(out[i + 2].v + 8, c);
+    _mm_store_ps(out[i + 3].v + 8, d);
+
+    // position already is a column, only w has to become 1
+    for (unsigned int j = 0; j < 4; ++j)
+    {
+      __m128 p = _mm_load_ps(&t[j].position.x);
+      // move 1 into lane 3, shuffle keeps x, y, z from p
+      __m128 hi = _mm_shuffle_ps(p, one, _MM_SHUFFLE(0, 0, 2, 2));
+      _mm_store_ps(out[i + j].v + 12, _mm_shuffle_ps(p, hi, _MM_SHUFFLE(2, 0, 1, 0)));
+    }
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    out[i] = transformToMat4(toTransform(in[i]));
+  }
+}
+
 // mat to transfrom is scale lossy (might contain skew data)
 // which makes it inaccurate
 Transform mat4ToTransform(const mat4& m)
@@ -114,7 +210,7 @@ Transform mat4ToTransform(const mat4& m)
 vec3 transformPoint(const Transform& a, const vec3& b)
 {
   vec3 out;
-  out = a.rotation * (a.scale * b);
+  out = a.rotation * scaled(b, a.scale);
   out = a.position + out;
   return out;
 }
@@ -122,6 +218,55 @@ vec3 transformPoint(const Transform& a, const vec3& b)
 vec3 transformVector(const Transform&a, const vec3& b)
 {
   vec3 out;
-  out = a.rotation * (a.scale * b);
+  out = a.rotation * scaled(b, a.scale);
+  return out;
+}
+
+// dual quats only carry rotation and translation, scale is dropped
+dualquat transformToDualQuat(const Transform& t)
+{
+  return rotationTranslationToDualQuat(t.rotation, t.position);
+}
+
+Transform dualQuatToTransform(const dualquat& dq)
+{
+  Transform out;
+  out.rotation = dq.real;
+  out.position = getTranslation(dq);
+  return out;
+}
+
+// aligned <-> packed conversion is a plain copy of each member
+TransformA toTransformA(const Transform& t)
+{
+  TransformA out;
+  out.position = vec3a(t.position);
+  out.rotation = t.rotation;
+  out.scale = vec3a(t.scale);
+  return out;
+}
+
+Transform toTransform(const TransformA& t)
+{
+  Transform out;
+  out.position = vec3(t.position);
+  out.rotation = t.rotation;
+  out.scale = vec3(t.scale);
   return out;
 }
+
+void toTransformA(const Transform* in, TransformA* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = toTransformA(in[i]);
+  }
+}
+
+void toTransform(const TransformA* in, Transform* out, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    out[i] = toTransform(in[i]);
+  }
+}
@@ -18,6 +18,23 @@ struct Transform
       {}
 };
 
+// 48 byte, 16 byte aligned storage variant of Transform
+// every member starts on a 16 byte boundary so whole skeletons can be
+// processed with aligned SIMD loads. this is what pose buffers store,
+// convert to Transform for the math below
+struct alignas(16) TransformA
+{
+  vec3a position;
+  alignas(16) quat rotation;
+  vec3a scale;
+
+  TransformA()
+      :position(vec3a(0, 0, 0))
+      , rotation(quat(0, 0, 0, 1))
+      , scale(vec3a(1, 1, 1))
+      {}
+};
+
 Transform combine(const Transform& a, Transform& b);
 Transform inverse(const Transform& t);
 Transform mix(const Transform& a, const Transform& b, float t);
@@ -25,3 +42,12 @@ mat4 transformToMat4(const Transform& t);
 Transform mat4ToTransform(const mat4& m);
 vec3 transformPoint(const Transform& a, const vec3& b);
 vec3 transformVector(const Transform& a, const vec3& b);
+dualquat transformToDualQuat(const Transform& t);
+Transform dualQuatToTransform(const dualquat& dq);
+TransformA toTransformA(const Transform& t);
+Transform toTransform(const TransformA& t);
+void toTransformA(const Transform* in, TransformA* out, unsigned int count);
+void toTransform(const TransformA* in, Transform* out, unsigned int count);
+// batched transformToMat4, writes count matrices into out
+void transformToMat4(const Transform* in, mat4* out, unsigned int count);
+void transformToMat4(const TransformA* in, mat4* out, unsigned int count);
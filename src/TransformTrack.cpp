@@ -0,0 +1,114 @@
+#include "TransformTrack.h"
+
+TransformTrack::TransformTrack()
+{
+  m_Id = 0;
+}
+
+unsigned int TransformTrack::GetId()
+{
+  return m_Id;
+}
+
+void TransformTrack::SetId(unsigned int id)
+{
+  m_Id = id;
+}
+
+VectorTrack& TransformTrack::GetPositionTrack()
+{
+  return m_Position;
+}
+
+QuaternionTrack& TransformTrack::GetRotationTrack()
+{
+  return m_Rotation;
+}
+
+VectorTrack& TransformTrack::GetScaleTrack()
+{
+  return m_Scale;
+}
+
+bool TransformTrack::IsValid()
+{
+  return m_Position.Size() > 1 || m_Rotation.Size() > 1 || m_Scale.Size() > 1;
+}
+
+// earliest start of the animated component tracks
+float TransformTrack::GetStartTime()
+{
+  float result = 0.0f;
+  bool isSet = false;
+  if (m_Position.Size() > 1)
+  {
+    result = m_Position.GetStartTime();
+    isSet = true;
+  }
+  if (m_Rotation.Size() > 1)
+  {
+    float start = m_Rotation.GetStartTime();
+    if (start < result || !isSet)
+    {
+      result = start;
+      isSet = true;
+    }
+  }
+  if (m_Scale.Size() > 1)
+  {
+    float start = m_Scale.GetStartTime();
+    if (start < result || !isSet)
+    {
+      result = start;
+    }
+  }
+  return result;
+}
+
+// latest end of the animated component tracks
+float TransformTrack::GetEndTime()
+{
+  float result = 0.0f;
+  bool isSet = false;
+  if (m_Position.Size() > 1)
+  {
+    result = m_Position.GetEndTime();
+    isSet = true;
+  }
+  if (m_Rotation.Size() > 1)
+  {
+    float end = m_Rotation.GetEndTime();
+    if (end > result || !isSet)
+    {
+      result = end;
+      isSet = true;
+    }
+  }
+  if (m_Scale.Size() > 1)
+  {
+    float end = m_Scale.GetEndTime();
+    if (end > result || !isSet)
+    {
+      result = end;
+    }
+  }
+  return result;
+}
+
+Transform TransformTrack::Sample(const Transform& ref, float time, bool looping)
+{
+  Transform result = ref;
+  if (m_Position.Size() > 1)
+  {
+    result.position = m_Position.Sample(time, looping);
+  }
+  if (m_Rotation.Size() > 1)
+  {
+    result.rotation = m_Rotation.Sample(time, looping);
+  }
+  if (m_Scale.Size() > 1)
+  {
+    result.scale = m_Scale.Sample(time, looping);
+  }
+  return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Track.h"
+#include "Transform.h"
+
+class TransformTrack {
+  // the animated position, rotation and scale of one joint
+  // a component track with less than two frames isn't animated,
+  // sampling keeps that component from the reference transform
+protected:
+  unsigned int m_Id;
+  VectorTrack m_Position;
+  QuaternionTrack m_Rotation;
+  VectorTrack m_Scale;
+
+public:
+  TransformTrack();
+  unsigned int GetId();
+  void SetId(unsigned int id);
+  VectorTrack& GetPositionTrack();
+  QuaternionTrack& GetRotationTrack();
+  VectorTrack& GetScaleTrack();
+  float GetStartTime();
+  float GetEndTime();
+  bool IsValid();
+  Transform Sample(const Transform& ref, float time, bool looping);
+};
@@ -12,6 +12,7 @@ template Uniform<vec3>;
 template Uniform<vec4>;
 template Uniform<quat>;
 template Uniform<mat4>;
+template Uniform<dualquat>;
 
 #define UNIFORM_IMPL(gl_func, tType, dType) \
   template<> void Uniform<tType>::Set(unsigned int slot, \
@@ -36,6 +37,13 @@ Uniform<mat4>::Set(unsigned int slot, mat4* inputArr, unsigned int arrLen)
   glUniformMatrix4fv(slot, (GLsizei) arrLen, false, (float*)&inputArr[0]);
 }
 
+// dual quats are uploaded as mat2x4, column 0 is real and column 1 dual
+template<> void
+Uniform<dualquat>::Set(unsigned int slot, dualquat* inputArr, unsigned int arrLen)
+{
+  glUniformMatrix2x4fv(slot, (GLsizei) arrLen, false, (float*)&inputArr[0]);
+}
+
 // helpers, just call above Set ()
 template<typename T>
 void Uniform<T>::Set(unsigned int slot, const T& value)
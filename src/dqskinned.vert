@@ -0,0 +1,67 @@
+#version 330 core
+
+// a dual quat bone is 2 vec4s against 4 for a mat4, so twice as
+// many bones fit in the same uniform space as skinned.vert
+#define MAX_BONES 240
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// dual quat pose palette with the inverse bind pose already combined in
+// column 0 is the real part (rotation), column 1 the dual part
+uniform mat2x4 animated[MAX_BONES];
+
+in vec3 position;
+in vec3 normal;
+in vec2 texCoord;
+in vec4 weights;
+in ivec4 joints;
+
+out vec3 norm;
+out vec3 fragPos;
+out vec2 uv;
+
+// same multiplication order as the quat operator* in Math.cpp
+vec4 mulQ(vec4 q1, vec4 q2) {
+  return vec4(
+      q2.x*q1.w + q2.y*q1.z - q2.z*q1.y + q2.w*q1.x
+    , -q2.x*q1.z + q2.y*q1.w + q2.z*q1.x + q2.w*q1.y
+    , q2.x*q1.y - q2.y*q1.x + q2.z*q1.w + q2.w*q1.z
+    , -q2.x*q1.x - q2.y*q1.y - q2.z*q1.z + q2.w*q1.w
+  );
+}
+
+vec3 rotateQ(vec4 q, vec3 v) {
+  return q.xyz * 2.0 * dot(q.xyz, v)
+       + v * (q.w * q.w - dot(q.xyz, q.xyz))
+       + cross(q.xyz, v) * 2.0 * q.w;
+}
+
+void main() {
+  // neighborhood every bone against the first one so the blend
+  // takes the short way around
+  vec4 w = weights;
+  mat2x4 dq0 = animated[joints.x];
+  mat2x4 dq1 = animated[joints.y];
+  mat2x4 dq2 = animated[joints.z];
+  mat2x4 dq3 = animated[joints.w];
+  if (dot(dq0[0], dq1[0]) < 0.0) { w.y *= -1.0; }
+  if (dot(dq0[0], dq2[0]) < 0.0) { w.z *= -1.0; }
+  if (dot(dq0[0], dq3[0]) < 0.0) { w.w *= -1.0; }
+
+  mat2x4 skin = dq0 * w.x + dq1 * w.y + dq2 * w.z + dq3 * w.w;
+  float invLen = 1.0 / length(skin[0]);
+  vec4 real = skin[0] * invLen;
+  vec4 dual = skin[1] * invLen;
+
+  // translation = 2 * dual * conjugate(real)
+  vec4 t = mulQ(vec4(-real.xyz, real.w), dual * 2.0);
+  vec3 skinnedPos = rotateQ(real, position) + t.xyz;
+  vec3 skinnedNorm = rotateQ(real, normal);
+
+  gl_Position = projection * view * model * vec4(skinnedPos, 1.0);
+  fragPos = vec3(model * vec4(skinnedPos, 1.0));
+  norm = vec3(model * vec4(skinnedNorm, 0.0));
+  uv = texCoord;
+}
@@ -0,0 +1,50 @@
+#version 330 core
+
+// skinned.vert for QuantizedMesh vertices. the normalized attributes
+// already arrive as floats, only the position bounds and the
+// octahedral normal need undoing here
+
+#define MAX_BONES 120
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// pose palette with the inverse bind pose already multiplied in
+uniform mat4 animated[MAX_BONES];
+
+// QuantizedMesh::GetBounds
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+in vec3 position; // snorm16
+in vec2 normal;   // snorm16 octahedral
+in vec2 texCoord; // half
+in vec4 weights;  // unorm8
+in uvec4 joints;  // uint8
+
+out vec3 norm;
+out vec3 fragPos;
+out vec2 uv;
+
+// same as octDecode in Quantize.cpp
+vec3 octDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+void main() {
+  mat4 skin = animated[joints.x] * weights.x
+            + animated[joints.y] * weights.y
+            + animated[joints.z] * weights.z
+            + animated[joints.w] * weights.w;
+
+  vec4 p = vec4(positionOffset + positionScale * position, 1.0);
+  gl_Position = projection * view * model * skin * p;
+  fragPos = vec3(model * skin * p);
+  norm = vec3(model * skin * vec4(octDecode(normal), 0.0));
+  uv = texCoord;
+}
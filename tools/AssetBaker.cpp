@@ -0,0 +1,38 @@
+// offline converter from glTF/GLB to the baked runtime format
+// (src/BakedAsset.h). build with make assetbaker, then
+//   ./assetbaker character.glb character.bake
+#include "../src/GLTFLoader.h"
+#include "../src/BakedAsset.h"
+#include <iostream>
+
+int main(int argc, char* args[])
+{
+  if (argc != 3)
+  {
+    std::cout<<"usage: assetbaker <input.gltf|input.glb> <output.bake>\n";
+    return 1;
+  }
+
+  GLTFLoadReport report;
+  cgltf_data* data = LoadGLTFFile(args[1], true, &report);
+  if (data == 0)
+  {
+    return 1;
+  }
+  PrintLoadReport(args[1], report);
+  // validated above, the game can load the source with
+  // LoadTrustedGLTFFile and this checksum
+  std::cout<<args[1]<<": checksum "<<std::hex<<GetGLTFChecksum(data)<<std::dec<<"\n";
+  Skeleton skeleton = LoadSkeleton(data);
+  std::vector<Clip> clips = LoadAnimationClips(data);
+  std::vector<Mesh> meshes = LoadCPUMeshes(data);
+  FreeGLTTFile(data);
+
+  if (!SaveBakedFile(args[2], skeleton, clips, meshes))
+  {
+    return 1;
+  }
+  std::cout<<args[2]<<": "<<skeleton.Size()<<" joints, "
+    <<clips.size()<<" clips, "<<meshes.size()<<" meshes\n";
+  return 0;
+}